@@ -0,0 +1,192 @@
+#include "Benchmark.h"
+
+#include <cstdio>
+#include <string_view>
+#include <numeric>
+
+namespace Expanse::Bench
+{
+	namespace
+	{
+		struct BenchmarkInfo
+		{
+			std::string name;
+			BenchmarkFunc func;
+			std::vector<size_t> counts;
+		};
+
+		std::vector<BenchmarkInfo>& GetRegistry()
+		{
+			static std::vector<BenchmarkInfo> registry;
+			return registry;
+		}
+
+		// Summary of a single case, times are in seconds
+		struct Result
+		{
+			std::string name;
+			size_t count = 0;
+			size_t runs = 0;
+			float best = 0.0f;
+			float mean = 0.0f;
+			float median = 0.0f;
+			size_t items_per_run = 0;
+
+			// per item time of the best run, 0 if benchmark doesn't report items
+			float ItemNs() const { return (items_per_run > 0) ? best * 1e9f / static_cast<float>(items_per_run) : 0.0f; }
+			// items processed per second in the best run, e.g. chunks/sec
+			double ItemsPerSec() const { return (items_per_run > 0) ? static_cast<double>(items_per_run) / best : 0.0; }
+		};
+
+		Result Summarize(const std::string& name, const State& state)
+		{
+			auto times = state.Times();
+			std::ranges::sort(times);
+
+			Result result;
+			result.name = name;
+			result.count = state.Count();
+			result.runs = times.size();
+			result.best = times.front();
+			result.mean = std::accumulate(times.begin(), times.end(), 0.0f) / static_cast<float>(times.size());
+			result.median = times[times.size() / 2];
+			result.items_per_run = state.ItemsPerRun();
+			return result;
+		}
+
+		enum class Format { Table, Csv, Json };
+
+		void PrintTableHeader(FILE* out)
+		{
+			std::fprintf(out, "%-40s %10s %12s %12s %12s %14s\n", "Benchmark", "Count", "Best, ms", "Mean, ms", "Item, ns", "Items/s");
+		}
+
+		void PrintTableRow(FILE* out, const Result& result)
+		{
+			std::fprintf(out, "%-40s %10zu %12.3f %12.3f", result.name.c_str(), result.count, result.best * 1e3f, result.mean * 1e3f);
+			if (result.items_per_run > 0) {
+				std::fprintf(out, " %12.2f %14.0f", result.ItemNs(), result.ItemsPerSec());
+			}
+			std::fprintf(out, "\n");
+		}
+
+		void PrintCsv(FILE* out, const std::vector<Result>& results)
+		{
+			std::fprintf(out, "name,count,runs,best_ms,mean_ms,median_ms,items_per_run,item_ns,items_per_sec\n");
+			for (const auto& result : results)
+			{
+				std::fprintf(out, "%s,%zu,%zu,%.6f,%.6f,%.6f,%zu,%.3f,%.1f\n", result.name.c_str(), result.count, result.runs,
+					result.best * 1e3f, result.mean * 1e3f, result.median * 1e3f, result.items_per_run, result.ItemNs(), result.ItemsPerSec());
+			}
+		}
+
+		// benchmark names are C++ identifiers, so they don't need escaping
+		void PrintJson(FILE* out, const std::vector<Result>& results)
+		{
+			std::fprintf(out, "{\n  \"benchmarks\": [");
+			for (size_t i = 0; i < results.size(); ++i)
+			{
+				const auto& result = results[i];
+				std::fprintf(out, "%s\n    {\"name\": \"%s\", \"count\": %zu, \"runs\": %zu, \"best_ms\": %.6f, \"mean_ms\": %.6f, \"median_ms\": %.6f, \"items_per_run\": %zu, \"item_ns\": %.3f, \"items_per_sec\": %.1f}",
+					(i > 0) ? "," : "", result.name.c_str(), result.count, result.runs,
+					result.best * 1e3f, result.mean * 1e3f, result.median * 1e3f, result.items_per_run, result.ItemNs(), result.ItemsPerSec());
+			}
+			std::fprintf(out, "\n  ]\n}\n");
+		}
+	}
+
+	const void* volatile escape_sink = nullptr;
+
+	void Register(std::string name, BenchmarkFunc func, std::vector<size_t> counts)
+	{
+		GetRegistry().push_back({ std::move(name), func, std::move(counts) });
+	}
+}
+
+/*
+* Runs registered benchmarks, options:
+*
+*	--filter=<str>				only benchmarks, which names contain the string, are run
+*	--format=table|csv|json		output format, table by default
+*	--out=<path>				file to write results to, stdout by default
+*
+* Table is printed as cases finish, other formats are written once all cases are done.
+*/
+int main(int argc, char* argv[])
+{
+	using namespace Expanse::Bench;
+
+	std::string_view filter;
+	std::string_view out_path;
+	Format format = Format::Table;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view arg = argv[i];
+		if (arg.starts_with("--filter=")) {
+			filter = arg.substr(9);
+		}
+		else if (arg.starts_with("--out=")) {
+			out_path = arg.substr(6);
+		}
+		else if (arg == "--format=csv") {
+			format = Format::Csv;
+		}
+		else if (arg == "--format=json") {
+			format = Format::Json;
+		}
+		else if (arg != "--format=table")
+		{
+			std::fprintf(stderr, "Unknown option: %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	FILE* out = stdout;
+	if (!out_path.empty())
+	{
+		out = std::fopen(std::string{ out_path }.c_str(), "w");
+		if (!out)
+		{
+			std::fprintf(stderr, "Can't open %s\n", std::string{ out_path }.c_str());
+			return 1;
+		}
+	}
+
+	if (format == Format::Table) {
+		PrintTableHeader(out);
+	}
+
+	std::vector<Result> results;
+	for (const auto& bench : GetRegistry())
+	{
+		if (!filter.empty() && bench.name.find(filter) == std::string::npos)
+			continue;
+
+		for (const auto count : bench.counts)
+		{
+			State state{ count };
+			bench.func(state);
+			if (state.Times().empty())
+				continue;
+
+			results.push_back(Summarize(bench.name, state));
+			if (format == Format::Table)
+			{
+				PrintTableRow(out, results.back());
+				std::fflush(out);
+			}
+		}
+	}
+
+	if (format == Format::Csv) {
+		PrintCsv(out, results);
+	} else if (format == Format::Json) {
+		PrintJson(out, results);
+	}
+
+	if (out != stdout) {
+		std::fclose(out);
+	}
+	return 0;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Utils/Timers.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+namespace Expanse::Bench
+{
+	/*
+	* Per-case benchmark state. Benchmark function does its setup,
+	* then calls Measure() with the code to be timed.
+	*/
+	class State
+	{
+	public:
+		explicit State(size_t n) : count(n) {}
+
+		// Input size of the current case
+		size_t Count() const { return count; }
+
+		// Number of items processed by one measured run, used to report per-item time
+		void SetItemsPerRun(size_t items) { items_per_run = items; }
+
+		// Runs func repeatedly, until both minimal time and minimal number of runs are reached
+		template<typename Func>
+		void Measure(Func&& func)
+		{
+			Measure([]{ return 0; }, [&func](int) { func(); });
+		}
+
+		// Same as above, but setup() is called before each run and is not timed.
+		// Value returned by setup() is passed to func().
+		template<typename Setup, typename Func>
+		void Measure(Setup&& setup, Func&& func)
+		{
+			float total_time = 0.0f;
+			while (times.size() < MinRuns || (total_time < MinTime && times.size() < MaxRuns))
+			{
+				auto ctx = setup();
+
+				Timer timer;
+				func(ctx);
+				const auto elapsed = timer.Elapsed();
+
+				times.push_back(elapsed);
+				total_time += elapsed;
+			}
+		}
+
+		size_t ItemsPerRun() const { return items_per_run; }
+		const std::vector<float>& Times() const { return times; }
+
+	private:
+		static constexpr size_t MinRuns = 3;
+		static constexpr size_t MaxRuns = 1000;
+		static constexpr float MinTime = 0.25f; // seconds
+
+		size_t count = 0;
+		size_t items_per_run = 0;
+		std::vector<float> times;
+	};
+
+	using BenchmarkFunc = void (*)(State&);
+
+	void Register(std::string name, BenchmarkFunc func, std::vector<size_t> counts);
+
+	struct Registrar
+	{
+		Registrar(std::string name, BenchmarkFunc func, std::vector<size_t> counts) {
+			Register(std::move(name), func, std::move(counts));
+		}
+	};
+
+	// Defined in another translation unit, so stores to it can't be proven dead
+	extern const void* volatile escape_sink;
+
+	// Prevents compiler from optimizing away computation of the value
+	template<typename T>
+	void DoNotOptimize(const T& value)
+	{
+		// address escapes to the outside world, so the whole value has to be materialized in memory
+		escape_sink = &value;
+	}
+}
+
+/*
+* Declares and registers benchmark function, which is run once per each of given input sizes:
+*
+*	EXPANSE_BENCHMARK(Name, 1000, 10000) { ... state.Measure(...); }
+*/
+#define EXPANSE_BENCHMARK(name, ...) \
+	static void Bench_##name(::Expanse::Bench::State& state); \
+	static const ::Expanse::Bench::Registrar Bench_##name##_registrar{ #name, &Bench_##name, { __VA_ARGS__ } }; \
+	static void Bench_##name([[maybe_unused]] ::Expanse::Bench::State& state)
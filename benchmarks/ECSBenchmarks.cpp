@@ -0,0 +1,904 @@
+#include "Benchmark.h"
+
+#include "ECS/World.h"
+#include "ECS/ArchetypeWorld.h"
+#include "ECS/Snapshot.h"
+
+#include "Utils/Array2D.h"
+
+#include <tuple>
+#include <random>
+#include <cmath>
+#include <utility>
+
+namespace Expanse::Bench
+{
+	namespace
+	{
+		struct Position
+		{
+			float x = 0.0f;
+			float y = 0.0f;
+		};
+
+		// Stand-in for a loaded terrain chunk, so that snapshot benchmarks don't depend on Game code
+		struct ChunkCells
+		{
+			static constexpr int Size = 32;
+
+			Point position;
+			Array2D<uint8_t> types;
+			Array2D<int8_t> heights;
+
+			ChunkCells() = default;
+
+			explicit ChunkCells(Point pos)
+				: position(pos)
+				, types({ 0, 0, Size, Size }, 0)
+				, heights({ 0, 0, Size + 1, Size + 1 }, 0)
+			{}
+		};
+	}
+}
+
+namespace Expanse
+{
+	template<>
+	inline constexpr bool ecs::SnapshotComponent<Bench::Position> = true;
+
+	template<>
+	struct Serializer<Bench::ChunkCells>
+	{
+		static void Write(BinaryWriter& out, const Bench::ChunkCells& chunk)
+		{
+			out.Write(chunk.position);
+			out.Write(chunk.types);
+			out.Write(chunk.heights);
+		}
+
+		static void Read(BinaryReader& in, Bench::ChunkCells& chunk)
+		{
+			in.Read(chunk.position);
+			in.Read(chunk.types);
+			in.Read(chunk.heights);
+		}
+	};
+
+	template<>
+	inline constexpr bool ecs::SnapshotComponent<Bench::ChunkCells> = true;
+}
+
+namespace Expanse::Bench
+{
+	namespace
+	{
+
+		struct Velocity
+		{
+			float dx = 1.0f;
+			float dy = 1.0f;
+		};
+
+		// Payload components, used to split entities into several archetypes
+		template<int N>
+		struct Extra
+		{
+			int value = N;
+		};
+
+		template<class World>
+		std::vector<ecs::Entity> FillWorld(World& world, size_t count)
+		{
+			std::vector<ecs::Entity> entities;
+			entities.reserve(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				const auto ent = world.CreateEntity();
+				world.template AddComponent<Position>(ent);
+				world.template AddComponent<Velocity>(ent);
+				entities.push_back(ent);
+			}
+			return entities;
+		}
+
+		/*
+		* Previous storage layout, kept as a baseline for comparison: every entity owns
+		* a vector of indices into per-type component arrays, indexed by component type.
+		*/
+		template<class... Comps>
+		class IndexVectorWorld
+		{
+		public:
+			ecs::Entity CreateEntity()
+			{
+				slots.emplace_back();
+				return ecs::Entity{ slots.size() - 1 };
+			}
+
+			template<class Comp>
+			Comp* AddComponent(ecs::Entity ent)
+			{
+				auto& pool = std::get<Pool<Comp>>(pools);
+				pool.components.emplace_back();
+				pool.entities.push_back(ent);
+
+				auto& indices = slots[ent.Index()];
+				indices.resize(std::max(indices.size(), TypeIndex<Comp> + 1), ecs::NullComponentIndex);
+				indices[TypeIndex<Comp>] = static_cast<ecs::ComponentIndex>(pool.components.size() - 1);
+				return &pool.components.back();
+			}
+
+			template<class Comp>
+			Comp* GetComponent(ecs::Entity ent)
+			{
+				const auto idx = GetIndex<Comp>(ent);
+				return (idx != ecs::NullComponentIndex) ? &std::get<Pool<Comp>>(pools).components[idx] : nullptr;
+			}
+
+			template<class Comp>
+			bool RemoveComponent(ecs::Entity ent)
+			{
+				const auto idx = GetIndex<Comp>(ent);
+				if (idx == ecs::NullComponentIndex) return false;
+
+				auto& pool = std::get<Pool<Comp>>(pools);
+				const auto last = pool.components.size() - 1;
+				if (idx != last)
+				{
+					pool.components[idx] = std::move(pool.components[last]);
+					pool.entities[idx] = pool.entities[last];
+					slots[pool.entities[idx].Index()][TypeIndex<Comp>] = idx;
+				}
+				pool.components.pop_back();
+				pool.entities.pop_back();
+				slots[ent.Index()][TypeIndex<Comp>] = ecs::NullComponentIndex;
+				return true;
+			}
+
+			template<class Comp, class Comp2, class Func>
+			void ForEach(Func func)
+			{
+				auto& pool = std::get<Pool<Comp>>(pools);
+				auto& pool2 = std::get<Pool<Comp2>>(pools);
+				for (size_t i = 0; i < pool.entities.size(); ++i)
+				{
+					const auto ent = pool.entities[i];
+					const auto idx2 = GetIndex<Comp2>(ent);
+					if (idx2 != ecs::NullComponentIndex) {
+						func(ent, pool.components[i], pool2.components[idx2]);
+					}
+				}
+			}
+
+		private:
+			template<class Comp>
+			struct Pool
+			{
+				std::vector<Comp> components;
+				std::vector<ecs::Entity> entities;
+			};
+
+			template<class Comp>
+			static constexpr size_t TypeIndex = []{
+				size_t idx = 0;
+				((std::is_same_v<Comp, Comps> ? false : (++idx, true)) && ...);
+				return idx;
+			}();
+
+			template<class Comp>
+			ecs::ComponentIndex GetIndex(ecs::Entity ent) const
+			{
+				const auto& indices = slots[ent.Index()];
+				return (TypeIndex<Comp> < indices.size()) ? indices[TypeIndex<Comp>] : ecs::NullComponentIndex;
+			}
+
+			std::tuple<Pool<Comps>...> pools;
+			std::vector<std::vector<ecs::ComponentIndex>> slots;
+		};
+
+		using LegacyWorld = IndexVectorWorld<Position, Velocity>;
+
+		template<class World>
+		void AddComponents(State& state)
+		{
+			const auto count = state.Count();
+
+			struct Context
+			{
+				std::unique_ptr<World> world = std::make_unique<World>();
+				std::vector<ecs::Entity> entities;
+			};
+
+			state.SetItemsPerRun(count);
+			state.Measure([count]
+			{
+				Context ctx;
+				for (size_t i = 0; i < count; ++i) {
+					ctx.entities.push_back(ctx.world->CreateEntity());
+				}
+				return ctx;
+			},
+			[](Context& ctx)
+			{
+				for (const auto ent : ctx.entities) {
+					ctx.world->template AddComponent<Position>(ent);
+				}
+			});
+		}
+
+		template<class World>
+		void RemoveComponents(State& state)
+		{
+			const auto count = state.Count();
+
+			struct Context
+			{
+				std::unique_ptr<World> world = std::make_unique<World>();
+				std::vector<ecs::Entity> entities;
+			};
+
+			state.SetItemsPerRun(count);
+			state.Measure([count]
+			{
+				Context ctx;
+				ctx.entities = FillWorld(*ctx.world, count);
+				std::ranges::shuffle(ctx.entities, std::minstd_rand{ 42 });
+				return ctx;
+			},
+			[](Context& ctx)
+			{
+				for (const auto ent : ctx.entities) {
+					ctx.world->template RemoveComponent<Position>(ent);
+				}
+			});
+		}
+
+		template<class World>
+		void GetComponentsRandom(State& state)
+		{
+			World world;
+			auto entities = FillWorld(world, state.Count());
+			std::ranges::shuffle(entities, std::minstd_rand{ 42 });
+
+			state.SetItemsPerRun(entities.size());
+			state.Measure([&]
+			{
+				float sum = 0.0f;
+				for (const auto ent : entities) {
+					sum += world.template GetComponent<Velocity>(ent)->dx;
+				}
+				DoNotOptimize(sum);
+			});
+		}
+
+		template<class World>
+		void CreateDestroyEntities(State& state)
+		{
+			const auto count = state.Count();
+
+			World world;
+			std::vector<ecs::Entity> entities;
+			entities.reserve(count);
+
+			state.SetItemsPerRun(count);
+			state.Measure([&]
+			{
+				for (size_t i = 0; i < count; ++i) {
+					entities.push_back(world.CreateEntity());
+				}
+				for (const auto ent : entities) {
+					world.DestroyEntity(ent);
+				}
+				entities.clear();
+			});
+		}
+
+		// Half of the handles are stale, their slots were freed and partly reused
+		template<class World>
+		void CheckEntitiesRandom(State& state)
+		{
+			const auto count = state.Count();
+
+			World world;
+			std::vector<ecs::Entity> entities;
+			for (size_t i = 0; i < count; ++i) {
+				entities.push_back(world.CreateEntity());
+			}
+			for (size_t i = 0; i < count; i += 2) {
+				world.DestroyEntity(entities[i]);
+			}
+			for (size_t i = 0; i < count / 4; ++i) {
+				world.CreateEntity();
+			}
+			std::ranges::shuffle(entities, std::minstd_rand{ 42 });
+
+			state.SetItemsPerRun(count);
+			state.Measure([&]
+			{
+				size_t alive = 0;
+				for (const auto ent : entities) {
+					alive += world.HasEntity(ent) ? 1 : 0;
+				}
+				DoNotOptimize(alive);
+			});
+		}
+
+		template<class World>
+		void DestroyWithComponents(State& state)
+		{
+			const auto count = state.Count();
+
+			struct Context
+			{
+				std::unique_ptr<World> world = std::make_unique<World>();
+				std::vector<ecs::Entity> entities;
+			};
+
+			state.SetItemsPerRun(count);
+			state.Measure([count]
+			{
+				Context ctx;
+				ctx.entities = FillWorld(*ctx.world, count);
+				std::ranges::shuffle(ctx.entities, std::minstd_rand{ 42 });
+				return ctx;
+			},
+			[](Context& ctx)
+			{
+				for (const auto ent : ctx.entities) {
+					ctx.world->DestroyEntity(ent);
+				}
+			});
+		}
+
+		// Destroys random quarter of entities, either one by one or with a single batch call
+		template<class World, bool Batch>
+		void DestroyQuarterWithComponents(State& state)
+		{
+			const auto count = state.Count();
+
+			struct Context
+			{
+				std::unique_ptr<World> world = std::make_unique<World>();
+				std::vector<ecs::Entity> entities;
+			};
+
+			state.SetItemsPerRun(count);
+			state.Measure([count]
+			{
+				Context ctx;
+				ctx.entities = FillWorld(*ctx.world, count);
+				std::ranges::shuffle(ctx.entities, std::minstd_rand{ 42 });
+				ctx.entities.resize(count / 4);
+				return ctx;
+			},
+			[](Context& ctx)
+			{
+				if constexpr (Batch)
+				{
+					ctx.world->DestroyEntities(ctx.entities);
+				}
+				else
+				{
+					for (const auto ent : ctx.entities) {
+						ctx.world->DestroyEntity(ent);
+					}
+				}
+			});
+		}
+
+		template<class World>
+		void IterateOneComponent(State& state)
+		{
+			World world;
+			FillWorld(world, state.Count());
+
+			state.SetItemsPerRun(state.Count());
+			state.Measure([&]
+			{
+				float sum = 0.0f;
+				world.template ForEach<Position>([&sum](ecs::Entity, const Position& pos) {
+					sum += pos.x;
+				});
+				DoNotOptimize(sum);
+			});
+		}
+
+		template<class World>
+		void IterateTwoComponents(State& state)
+		{
+			World world;
+			FillWorld(world, state.Count());
+
+			state.SetItemsPerRun(state.Count());
+			state.Measure([&]
+			{
+				world.template ForEach<Position, Velocity>([](ecs::Entity, Position& pos, const Velocity& vel) {
+					pos.x += vel.dx;
+					pos.y += vel.dy;
+				});
+			});
+		}
+
+		// Per-entity work heavy enough for threading overhead not to dominate
+		void HeavyUpdate(Velocity& vel, const Position& pos)
+		{
+			float x = pos.x + 1.0f;
+			for (int i = 0; i < 32; ++i) {
+				x = std::sqrt(x * x + 1.0f) * 0.5f;
+			}
+			vel.dx = x;
+		}
+
+		// Only every other entity has both components, so View has to skip half of the driving store
+		std::vector<ecs::Entity> FillWorldPartial(ecs::World& world, size_t count)
+		{
+			std::vector<ecs::Entity> entities;
+			entities.reserve(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				const auto ent = world.CreateEntity();
+				world.AddComponent<Position>(ent);
+				if (i % 2 == 0) {
+					world.AddComponent<Velocity>(ent);
+				}
+				entities.push_back(ent);
+			}
+			return entities;
+		}
+
+		// Entities get random subsets of extra components, so queried ones are spread over 8 archetypes
+		template<class World>
+		void IterateFragmented(State& state)
+		{
+			World world;
+			const auto entities = FillWorld(world, state.Count());
+
+			std::minstd_rand rng{ 42 };
+			for (const auto ent : entities)
+			{
+				const auto mask = rng();
+				if (mask & 1) world.template AddComponent<Extra<0>>(ent);
+				if (mask & 2) world.template AddComponent<Extra<1>>(ent);
+				if (mask & 4) world.template AddComponent<Extra<2>>(ent);
+			}
+
+			state.SetItemsPerRun(state.Count());
+			state.Measure([&]
+			{
+				world.template ForEach<Position, Velocity>([](ecs::Entity, Position& pos, const Velocity& vel) {
+					pos.x += vel.dx;
+					pos.y += vel.dy;
+				});
+			});
+		}
+	}
+
+	/*
+	* Entity handles
+	*/
+
+	EXPANSE_BENCHMARK(ECS_Entity_CreateDestroy, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		CreateDestroyEntities<ecs::World>(state);
+	}
+
+	EXPANSE_BENCHMARK(ECS_Entity_HasEntity, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		CheckEntitiesRandom<ecs::World>(state);
+	}
+
+	/*
+	* Iteration
+	*/
+
+	EXPANSE_BENCHMARK(ECS_ForEach_OneComponent, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		IterateOneComponent<ecs::World>(state);
+	}
+
+	EXPANSE_BENCHMARK(ECS_ForEach_TwoComponents, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		IterateTwoComponents<ecs::World>(state);
+	}
+
+	/*
+	* Sparse set storage vs. per-entity index vectors
+	*/
+
+	EXPANSE_BENCHMARK(ECS_AddComponent, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		AddComponents<ecs::World>(state);
+	}
+
+	EXPANSE_BENCHMARK(Legacy_AddComponent, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		AddComponents<LegacyWorld>(state);
+	}
+
+	EXPANSE_BENCHMARK(ECS_RemoveComponent, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		RemoveComponents<ecs::World>(state);
+	}
+
+	EXPANSE_BENCHMARK(Legacy_RemoveComponent, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		RemoveComponents<LegacyWorld>(state);
+	}
+
+	EXPANSE_BENCHMARK(ECS_GetComponent_Random, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		GetComponentsRandom<ecs::World>(state);
+	}
+
+	EXPANSE_BENCHMARK(Legacy_GetComponent_Random, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		GetComponentsRandom<LegacyWorld>(state);
+	}
+
+	EXPANSE_BENCHMARK(Legacy_ForEach_TwoComponents, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		IterateTwoComponents<LegacyWorld>(state);
+	}
+
+	/*
+	* Sparse set storage vs. archetype storage
+	*/
+
+	EXPANSE_BENCHMARK(Archetype_Entity_CreateDestroy, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		CreateDestroyEntities<ecs::ArchetypeWorld>(state);
+	}
+
+	EXPANSE_BENCHMARK(Archetype_Entity_HasEntity, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		CheckEntitiesRandom<ecs::ArchetypeWorld>(state);
+	}
+
+	EXPANSE_BENCHMARK(ECS_Entity_DestroyWithComponents, 10'000, 100'000, 1'000'000)
+	{
+		DestroyWithComponents<ecs::World>(state);
+	}
+
+	EXPANSE_BENCHMARK(ECS_Entity_DestroyQuarter_OneByOne, 10'000, 100'000, 1'000'000)
+	{
+		DestroyQuarterWithComponents<ecs::World, false>(state);
+	}
+
+	EXPANSE_BENCHMARK(ECS_Entity_DestroyQuarter_Batch, 10'000, 100'000, 1'000'000)
+	{
+		DestroyQuarterWithComponents<ecs::World, true>(state);
+	}
+
+	EXPANSE_BENCHMARK(ECS_Entity_CreateWithComponents_OneByOne, 10'000, 100'000, 1'000'000)
+	{
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			ecs::World world;
+			DoNotOptimize(FillWorld(world, state.Count()));
+		});
+	}
+
+	EXPANSE_BENCHMARK(ECS_Entity_CreateWithComponents_Batch, 10'000, 100'000, 1'000'000)
+	{
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			ecs::World world;
+			DoNotOptimize(world.CreateEntities(state.Count(), Position{}, Velocity{}));
+		});
+	}
+
+	EXPANSE_BENCHMARK(Archetype_Entity_DestroyWithComponents, 10'000, 100'000, 1'000'000)
+	{
+		DestroyWithComponents<ecs::ArchetypeWorld>(state);
+	}
+
+	EXPANSE_BENCHMARK(Archetype_AddComponent, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		AddComponents<ecs::ArchetypeWorld>(state);
+	}
+
+	EXPANSE_BENCHMARK(Archetype_RemoveComponent, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		RemoveComponents<ecs::ArchetypeWorld>(state);
+	}
+
+	EXPANSE_BENCHMARK(Archetype_GetComponent_Random, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		GetComponentsRandom<ecs::ArchetypeWorld>(state);
+	}
+
+	EXPANSE_BENCHMARK(Archetype_ForEach_OneComponent, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		IterateOneComponent<ecs::ArchetypeWorld>(state);
+	}
+
+	EXPANSE_BENCHMARK(Archetype_ForEach_TwoComponents, 1'000, 10'000, 100'000, 1'000'000)
+	{
+		IterateTwoComponents<ecs::ArchetypeWorld>(state);
+	}
+
+	EXPANSE_BENCHMARK(ECS_ForEach_Fragmented, 10'000, 100'000, 1'000'000)
+	{
+		IterateFragmented<ecs::World>(state);
+	}
+
+	EXPANSE_BENCHMARK(Archetype_ForEach_Fragmented, 10'000, 100'000, 1'000'000)
+	{
+		IterateFragmented<ecs::ArchetypeWorld>(state);
+	}
+
+	/*
+	* Persistent groups vs. views
+	*/
+
+	EXPANSE_BENCHMARK(ECS_View_PartialMatch, 10'000, 100'000, 1'000'000)
+	{
+		ecs::World world;
+		FillWorldPartial(world, state.Count());
+
+		state.SetItemsPerRun(state.Count() / 2);
+		state.Measure([&]
+		{
+			world.ForEach<Position, Velocity>([](ecs::Entity, Position& pos, const Velocity& vel) {
+				pos.x += vel.dx;
+				pos.y += vel.dy;
+			});
+		});
+	}
+
+	EXPANSE_BENCHMARK(ECS_Group_PartialMatch, 10'000, 100'000, 1'000'000)
+	{
+		ecs::World world;
+		FillWorldPartial(world, state.Count());
+		auto group = world.Group<Position, Velocity>();
+
+		state.SetItemsPerRun(state.Count() / 2);
+		state.Measure([&]
+		{
+			group.ForEach([](ecs::Entity, Position& pos, const Velocity& vel) {
+				pos.x += vel.dx;
+				pos.y += vel.dy;
+			});
+		});
+	}
+
+	EXPANSE_BENCHMARK(ECS_Group_AddRemoveComponent, 10'000, 100'000, 1'000'000)
+	{
+		ecs::World world;
+		const auto entities = FillWorldPartial(world, state.Count());
+		world.Group<Position, Velocity>();
+
+		// every add and remove moves entity in or out of the group prefix
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			for (size_t i = 1; i < entities.size(); i += 2) {
+				world.AddComponent<Velocity>(entities[i]);
+			}
+			for (size_t i = 1; i < entities.size(); i += 2) {
+				world.RemoveComponent<Velocity>(entities[i]);
+			}
+		});
+	}
+
+	/*
+	* Draw order: copying group into a vector and sorting it every frame vs. keeping the group sorted in place
+	*/
+
+	// Stand-in for terrain meshes, which own their layers
+	struct MeshLayers
+	{
+		std::vector<int> layers = std::vector<int>(4, 0);
+	};
+
+	template<class World>
+	void FillSortedWorld(World& world, size_t count)
+	{
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const auto entity = world.CreateEntity();
+			world.template AddComponent<Position>(entity, dist(rng), dist(rng));
+			world.template AddComponent<MeshLayers>(entity);
+		}
+	}
+
+	constexpr auto DrawOrder = [](const Position& p1, const Position& p2) { return (p1.x + p1.y) > (p2.x + p2.y); };
+
+	EXPANSE_BENCHMARK(ECS_DrawOrder_CopyAndSort, 10'000, 100'000)
+	{
+		ecs::World world;
+		FillSortedWorld(world, state.Count());
+		auto group = world.Group<const MeshLayers, const Position>();
+
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			std::vector<std::pair<Position, MeshLayers>> items;
+			group.ForEach([&items](ecs::Entity, const MeshLayers& mesh, const Position& pos) { items.emplace_back(pos, mesh); });
+			std::ranges::sort(items, DrawOrder, [](const auto& item) -> const Position& { return item.first; });
+
+			size_t layers = 0;
+			for (const auto& [pos, mesh] : items) {
+				layers += mesh.layers.size();
+			}
+			DoNotOptimize(layers);
+		});
+	}
+
+	EXPANSE_BENCHMARK(ECS_DrawOrder_SortInPlace, 10'000, 100'000)
+	{
+		ecs::World world;
+		FillSortedWorld(world, state.Count());
+		auto group = world.Group<const MeshLayers, const Position>();
+
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			group.Sort<Position>(DrawOrder, ecs::SortMode::Incremental);
+
+			size_t layers = 0;
+			group.ForEach([&layers](ecs::Entity, const MeshLayers& mesh, const Position&) { layers += mesh.layers.size(); });
+			DoNotOptimize(layers);
+		});
+	}
+
+	/*
+	* Paged component pools
+	*/
+
+	// Components with their own heap buffers, which used to be moved on every store reallocation
+	struct HeavyComponent
+	{
+		std::vector<float> data = std::vector<float>(16, 1.0f);
+	};
+
+	EXPANSE_BENCHMARK(ECS_AddHeavyComponent, 10'000, 100'000, 1'000'000)
+	{
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			ecs::World world;
+			for (size_t i = 0; i < state.Count(); ++i) {
+				world.AddComponent<HeavyComponent>(world.CreateEntity());
+			}
+		});
+	}
+
+	EXPANSE_BENCHMARK(ECS_AddHeavyComponent_Reserved, 10'000, 100'000, 1'000'000)
+	{
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			ecs::World world;
+			world.Reserve<HeavyComponent>(state.Count());
+			for (size_t i = 0; i < state.Count(); ++i) {
+				world.AddComponent<HeavyComponent>(world.CreateEntity());
+			}
+		});
+	}
+
+	/*
+	* Parallel iteration
+	*/
+
+	EXPANSE_BENCHMARK(ECS_ForEach_HeavyUpdate, 10'000, 100'000, 1'000'000)
+	{
+		ecs::World world;
+		FillWorld(world, state.Count());
+
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			world.ForEach<Velocity, const Position>([](ecs::Entity, Velocity& vel, const Position& pos) {
+				HeavyUpdate(vel, pos);
+			});
+		});
+	}
+
+	EXPANSE_BENCHMARK(ECS_ParallelForEach_HeavyUpdate, 10'000, 100'000, 1'000'000)
+	{
+		ecs::World world;
+		FillWorld(world, state.Count());
+
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			world.ParallelForEach<Velocity, const Position>([](ecs::Entity, Velocity& vel, const Position& pos) {
+				HeavyUpdate(vel, pos);
+			});
+		});
+	}
+
+	/*
+	* Change filters
+	*/
+
+	// Nothing changes between updates, store-wide tick lets the query skip the whole store
+	EXPANSE_BENCHMARK(ECS_ChangedFilter_SteadyState, 10'000, 100'000, 1'000'000)
+	{
+		ecs::World world;
+		FillWorld(world, state.Count());
+		ecs::ChangeTick last_tick = 0;
+
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			const auto since = std::exchange(last_tick, world.AdvanceTick());
+			world.ForEach<const Position, ecs::Changed<Velocity>>([](ecs::Entity, const Position& pos) {
+				DoNotOptimize(pos);
+			}, since);
+		});
+	}
+
+	// Every 100th velocity is written between updates, the rest are filtered out per entity
+	EXPANSE_BENCHMARK(ECS_ChangedFilter_FewChanges, 10'000, 100'000, 1'000'000)
+	{
+		ecs::World world;
+		const auto entities = FillWorld(world, state.Count());
+		ecs::ChangeTick last_tick = 0;
+
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			for (size_t i = 0; i < entities.size(); i += 100) {
+				world.GetComponent<Velocity>(entities[i])->dx += 1.0f;
+			}
+
+			const auto since = std::exchange(last_tick, world.AdvanceTick());
+			world.ForEach<Position, ecs::Changed<Velocity>>([](ecs::Entity, Position& pos) {
+				pos.x += 1.0f;
+			}, since);
+		});
+	}
+
+	/*
+	* World snapshots, on a world of loaded terrain chunks
+	*/
+
+	void FillTerrainWorld(ecs::World& world, size_t chunks_count)
+	{
+		const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(chunks_count))));
+		for (size_t i = 0; i < chunks_count; ++i)
+		{
+			const auto entity = world.CreateEntity();
+			world.AddComponent<ChunkCells>(entity, Point{ static_cast<int>(i) % side, static_cast<int>(i) / side });
+			world.AddComponent<Position>(entity);
+		}
+	}
+
+	EXPANSE_BENCHMARK(ECS_Snapshot_Write, 1'000, 5'000)
+	{
+		ecs::World world;
+		FillTerrainWorld(world, state.Count());
+
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			BinaryWriter out;
+			world.WriteSnapshot(out);
+			DoNotOptimize(out.Size());
+		});
+	}
+
+	EXPANSE_BENCHMARK(ECS_Snapshot_Read, 1'000, 5'000)
+	{
+		ecs::World world;
+		FillTerrainWorld(world, state.Count());
+
+		BinaryWriter out;
+		world.WriteSnapshot(out);
+
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			ecs::World restored;
+			BinaryReader in{ out.Data() };
+			const bool ok = restored.ReadSnapshot(in);
+			DoNotOptimize(ok);
+		});
+	}
+}
\ No newline at end of file
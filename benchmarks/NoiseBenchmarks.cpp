@@ -0,0 +1,78 @@
+#include "Benchmark.h"
+
+#include "Utils/PerlinNoiseGenerator.h"
+#include "Utils/RectPoints.h"
+
+namespace Expanse::Bench
+{
+	namespace
+	{
+		// Same noise as procedural terrain evaluates per chunk: three type noises per cell and two height harmonics per vertex
+		constexpr int ChunkSize = 32;
+		constexpr float TypesFreq = 0.07f;
+		constexpr uint32_t TypeSeeds[3] = { 11u, 12u, 13u };
+
+		const PerlinNoiseGenerator& HeightGenerator()
+		{
+			static const PerlinNoiseGenerator gen{ 100u, { { 0.05f, -6.0f, 6.0f }, { 0.27f, -3.0f, 3.0f } } };
+			return gen;
+		}
+
+		Point ChunkPosition(size_t i)
+		{
+			return { static_cast<int>(i % 64) - 32, static_cast<int>(i / 64) - 32 };
+		}
+	}
+
+	EXPANSE_BENCHMARK(Noise_TerrainChunk_Scalar, 16, 256)
+	{
+		const auto& heights_gen = HeightGenerator();
+
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			float sum = 0.0f;
+			for (size_t i = 0; i < state.Count(); ++i)
+			{
+				const auto origin = ChunkPosition(i) * ChunkSize;
+				for (const Point pt : utils::rect_points{ Rect{ origin.x, origin.y, ChunkSize, ChunkSize } })
+				{
+					for (const auto seed : TypeSeeds) {
+						sum += PerlinNoise(FPoint{ pt } * TypesFreq, seed);
+					}
+				}
+				for (const Point pt : utils::rect_points{ Rect{ origin.x, origin.y, ChunkSize + 1, ChunkSize + 1 } }) {
+					sum += heights_gen.Get(FPoint{ pt });
+				}
+			}
+			DoNotOptimize(sum);
+		});
+	}
+
+	EXPANSE_BENCHMARK(Noise_TerrainChunk_Fill, 16, 256)
+	{
+		const auto& heights_gen = HeightGenerator();
+
+		state.SetItemsPerRun(state.Count());
+		state.Measure([&]
+		{
+			float sum = 0.0f;
+			for (size_t i = 0; i < state.Count(); ++i)
+			{
+				const auto origin = ChunkPosition(i) * ChunkSize;
+
+				Array2D<float> types{ Rect{ origin.x, origin.y, ChunkSize, ChunkSize } };
+				for (const auto seed : TypeSeeds)
+				{
+					PerlinNoiseFill(types, TypesFreq, seed);
+					sum += types[origin];
+				}
+
+				Array2D<float> heights{ Rect{ origin.x, origin.y, ChunkSize + 1, ChunkSize + 1 } };
+				heights_gen.Fill(heights);
+				sum += heights[origin];
+			}
+			DoNotOptimize(sum);
+		});
+	}
+}
@@ -9,6 +9,7 @@
 #include "Utils/Random.h"
 
 #include "Game/Terrain/Systems/GenerateTerrain.h"
+#include "Game/Terrain/Systems/DiskTerrain.h"
 #include "Game/Terrain/Systems/StreamTerrainGPU.h"
 #include "Game/Terrain/Systems/RenderTerrain.h"
 #include "Game/Terrain/Systems/DrawTerrainGrid.h"
@@ -25,7 +26,9 @@ namespace Expanse
             RenderWorldSystem(World& w, Render::IRenderer* r)
                 : SystemCollection(w)
                 , renderer(r)
-            {}
+            {
+                access.MainThread().Read<Fields::Camera>();
+            }
 
             void Update() override
             {
@@ -48,6 +51,7 @@ namespace Expanse
                 : SystemCollection(w)
                 , imgui_render(renderer)
             {
+                access.MainThread();
             }
 
             void Update() override
@@ -62,6 +66,21 @@ namespace Expanse
         };
     }
 
+    namespace
+    {
+        // Per-user writable directory, so that the cache doesn't depend on the working directory
+        std::string GetTerrainCacheDir()
+        {
+            std::string dir = "cache";
+            if (char* pref_path = SDL_GetPrefPath("Expanse", "Expanse"))
+            {
+                dir = std::string{ pref_path } + "cache";
+                SDL_free(pref_path);
+            }
+            return dir + "/terrain";
+        }
+    }
+
 
     void Application::Init(Point window_size, Point framebuffer_size)
     {
@@ -171,6 +190,7 @@ namespace Expanse
     void GameScreen::Update(float dt)
     {
         world.dt = dt;
+        world.entities.BeginFrame();
 
         systems->Update();
     }
@@ -183,7 +203,11 @@ namespace Expanse
 
         systems->AddSystem<Game::Player::ScrollCamera>();
 
-        systems->AddSystem<Game::Terrain::LoadChunks>(GetRandomSeed(), window_size);
+        // world is kept between launches together with its terrain cache
+        const auto terrain_cache = GetTerrainCacheDir();
+        const auto seed = Game::Terrain::TerrainLoader_Disk::LoadOrCreateSeed(terrain_cache, GetRandomSeed());
+
+        systems->AddSystem<Game::Terrain::LoadChunks>(seed, terrain_cache, window_size);
         systems->AddSystem<Game::Terrain::UnloadChunks>(window_size);
 
         systems->AddSystem<Game::Terrain::LoadChunksToGPU>(renderer);
@@ -198,7 +222,7 @@ namespace Expanse
         auto gui_system = systems->AddSystem<Game::RenderGUISystem>(gui_render);
         {
             //gui_system->AddSystem<LogWindowSystem>();
-            gui_system->AddSystem<DebugWindowSystem>();
+            gui_system->AddSystem<DebugWindowSystem>(systems.get());
         }
     }
 
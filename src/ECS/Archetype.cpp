@@ -0,0 +1,122 @@
+#include "Archetype.h"
+
+#include <cassert>
+#include <algorithm>
+
+namespace Expanse::ecs
+{
+	namespace
+	{
+		size_t AlignUp(size_t value, size_t align)
+		{
+			return (value + align - 1) / align * align;
+		}
+	}
+
+	Archetype::Archetype(std::vector<const ComponentTypeInfo*> types_)
+		: types(std::move(types_))
+	{
+		assert(std::ranges::is_sorted(types, {}, &ComponentTypeInfo::type_index));
+
+		// reserve space for worst case alignment padding of every column
+		size_t row_size = sizeof(Entity);
+		size_t padding = 0;
+		for (const auto* type : types)
+		{
+			assert(type->align <= ChunkAlign);
+			row_size += type->size;
+			padding += type->align;
+		}
+
+		// components don't fit into a chunk even once, such archetype can't be created
+		if (row_size + padding > ChunkSize)
+			return;
+
+		capacity = (ChunkSize - padding) / row_size;
+
+		size_t offset = capacity * sizeof(Entity);
+		for (const auto* type : types)
+		{
+			offset = AlignUp(offset, type->align);
+			offsets.push_back(offset);
+			offset += capacity * type->size;
+		}
+		assert(offset <= ChunkSize);
+
+		if (!types.empty()) {
+			columns_by_type.resize(types.back()->type_index + 1, -1);
+		}
+		for (size_t col = 0; col < types.size(); ++col) {
+			columns_by_type[types[col]->type_index] = static_cast<int>(col);
+		}
+	}
+
+	Archetype::~Archetype()
+	{
+		for (auto& chunk : chunks)
+		{
+			for (size_t col = 0; col < types.size(); ++col)
+			{
+				auto* column = static_cast<std::byte*>(Column(chunk, static_cast<int>(col)));
+				for (size_t row = 0; row < chunk.count; ++row) {
+					types[col]->destroy(column + row * types[col]->size);
+				}
+			}
+		}
+	}
+
+	ArchetypeRow Archetype::Push(Entity entity)
+	{
+		if (chunks.empty() || chunks.back().count == capacity)
+		{
+			// chunk memory is left uninitialized, rows are constructed one by one
+			chunks.push_back({ std::unique_ptr<ChunkData>(new ChunkData), 0 });
+		}
+
+		auto& chunk = chunks.back();
+		const ArchetypeRow pos{ static_cast<uint32_t>(chunks.size() - 1), static_cast<uint32_t>(chunk.count) };
+
+		Entities(chunk)[pos.row] = entity;
+		++chunk.count;
+		++size;
+
+		return pos;
+	}
+
+	Entity Archetype::Erase(ArchetypeRow pos)
+	{
+		assert(pos.chunk < chunks.size() && pos.row < chunks[pos.chunk].count);
+
+		auto& last_chunk = chunks.back();
+		const ArchetypeRow last{ static_cast<uint32_t>(chunks.size() - 1), static_cast<uint32_t>(last_chunk.count - 1) };
+		const bool is_last = (pos.chunk == last.chunk) && (pos.row == last.row);
+
+		Entity moved;
+		for (size_t col = 0; col < types.size(); ++col)
+		{
+			const auto* type = types[col];
+			void* dst = Component(pos, static_cast<int>(col));
+			type->destroy(dst);
+
+			if (!is_last)
+			{
+				void* src = Component(last, static_cast<int>(col));
+				type->move_construct(dst, src);
+				type->destroy(src);
+			}
+		}
+
+		if (!is_last)
+		{
+			moved = Entities(last_chunk)[last.row];
+			Entities(chunks[pos.chunk])[pos.row] = moved;
+		}
+
+		if (--last_chunk.count == 0) {
+			chunks.pop_back();
+		}
+		--size;
+
+		return moved;
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Entity.h"
+#include "TypeIndex.h"
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <type_traits>
+
+namespace Expanse::ecs
+{
+	/*
+	* Type-erased description of component type, used by archetype storage
+	* to move and destroy components without knowing their type.
+	*/
+	struct ComponentTypeInfo
+	{
+		size_t type_index;
+		size_t size;
+		size_t align;
+
+		void (*move_construct)(void* dst, void* src);
+		void (*destroy)(void* ptr);
+
+		template<class Comp>
+		static const ComponentTypeInfo* Get()
+		{
+			static const ComponentTypeInfo info{
+				ComponentTypeIndex<Comp>,
+				sizeof(Comp),
+				alignof(Comp),
+				[](void* dst, void* src) { new(dst) Comp(std::move(*static_cast<Comp*>(src))); },
+				[](void* ptr) { static_cast<Comp*>(ptr)->~Comp(); }
+			};
+			return &info;
+		}
+	};
+
+	// Position of entity's components inside archetype
+	struct ArchetypeRow
+	{
+		uint32_t chunk = 0;
+		uint32_t row = 0;
+	};
+
+	/*
+	* Storage of all entities having exactly the same set of components.
+	* Entities are packed into fixed size chunks, each chunk holds a column of entities
+	* followed by one contiguous column per component type.
+	*/
+	class Archetype
+	{
+	public:
+		static constexpr size_t ChunkSize = 16 * 1024;
+		static constexpr size_t ChunkAlign = 64;
+
+		struct alignas(ChunkAlign) ChunkData
+		{
+			std::byte bytes[ChunkSize];
+		};
+
+		struct Chunk
+		{
+			std::unique_ptr<ChunkData> data;
+			size_t count = 0;
+		};
+
+		// types must be sorted by type index, archetype is invalid if one row doesn't fit into a chunk
+		explicit Archetype(std::vector<const ComponentTypeInfo*> types);
+		~Archetype();
+
+		Archetype(const Archetype&) = delete;
+		Archetype& operator=(const Archetype&) = delete;
+
+		const std::vector<const ComponentTypeInfo*>& Types() const noexcept { return types; }
+
+		// Column of component type in chunks, or -1 if archetype doesn't have it
+		int ColumnOf(size_t type_index) const noexcept
+		{
+			return (type_index < columns_by_type.size()) ? columns_by_type[type_index] : -1;
+		}
+
+		bool Has(size_t type_index) const noexcept { return ColumnOf(type_index) >= 0; }
+
+		bool IsValid() const noexcept { return capacity > 0; }
+
+		size_t ChunkCapacity() const noexcept { return capacity; }
+		size_t Size() const noexcept { return size; }
+
+		const std::vector<Chunk>& Chunks() const noexcept { return chunks; }
+
+		Entity* Entities(const Chunk& chunk) const noexcept
+		{
+			return reinterpret_cast<Entity*>(chunk.data->bytes);
+		}
+
+		void* Column(const Chunk& chunk, int column) const noexcept
+		{
+			return chunk.data->bytes + offsets[column];
+		}
+
+		void* Component(ArchetypeRow pos, int column) const noexcept
+		{
+			return static_cast<std::byte*>(Column(chunks[pos.chunk], column)) + pos.row * types[column]->size;
+		}
+
+		// Appends entity, leaving its components uninitialized
+		ArchetypeRow Push(Entity entity);
+
+		// Destroys components at given row and fills the hole with the last row.
+		// Returns entity, that was moved into the row, or null entity if nothing was moved.
+		Entity Erase(ArchetypeRow pos);
+
+		// Structural change graph: archetype with one component added or removed, cached on first use
+		std::vector<Archetype*> add_edges;
+		std::vector<Archetype*> remove_edges;
+
+	private:
+		std::vector<const ComponentTypeInfo*> types;
+		std::vector<int> columns_by_type;
+		std::vector<size_t> offsets;
+		size_t capacity = 0;
+		size_t size = 0;
+
+		std::vector<Chunk> chunks;
+	};
+}
@@ -0,0 +1,143 @@
+#include "ArchetypeWorld.h"
+
+namespace Expanse::ecs
+{
+	ArchetypeWorld::ArchetypeWorld()
+	{
+		empty_archetype = GetArchetype({});
+	}
+
+	Entity ArchetypeWorld::CreateEntity()
+	{
+		Entity entity;
+		if (free_head == NullIndex)
+		{
+			assert(records.size() < static_cast<size_t>(Entity::MaxIndex));
+			records.emplace_back(records.size());
+			entity = records.back().entity;
+		}
+		else
+		{
+			auto& slot = records[free_head];
+			entity = Entity{ free_head, slot.entity.Version() };
+			free_head = slot.entity.Index();
+			slot.entity = entity;
+		}
+
+		auto& record = records[entity.Index()];
+		record.archetype = empty_archetype;
+		record.pos = empty_archetype->Push(entity);
+		return entity;
+	}
+
+	void ArchetypeWorld::DestroyEntity(Entity entity)
+	{
+		assert(HasEntity(entity));
+
+		auto& record = records[entity.Index()];
+		if (const auto moved = record.archetype->Erase(record.pos)) {
+			records[moved.Index()].pos = record.pos;
+		}
+		record.archetype = nullptr;
+
+		const auto idx = entity.Index();
+		entity.IncVersion();
+		record.entity = Entity{ free_head, entity.Version() };
+		free_head = idx;
+	}
+
+	bool ArchetypeWorld::HasEntity(Entity entity) const
+	{
+		const auto idx = entity.Index();
+		return (idx < records.size()) && (records[idx].entity == entity);
+	}
+
+	Archetype* ArchetypeWorld::GetArchetype(std::vector<const ComponentTypeInfo*> types)
+	{
+		std::vector<size_t> signature;
+		signature.reserve(types.size());
+		for (const auto* type : types) {
+			signature.push_back(type->type_index);
+		}
+
+		auto [itr, inserted] = archetypes.try_emplace(std::move(signature));
+		if (inserted)
+		{
+			itr->second = std::make_unique<Archetype>(std::move(types));
+			if (!itr->second->IsValid())
+			{
+				archetypes.erase(itr);
+				return nullptr;
+			}
+		}
+		return itr->second.get();
+	}
+
+	Archetype* ArchetypeWorld::GetAddTarget(Archetype* archetype, const ComponentTypeInfo* type)
+	{
+		auto& edges = archetype->add_edges;
+		edges.resize(std::max(edges.size(), type->type_index + 1), nullptr);
+
+		auto& target = edges[type->type_index];
+		if (!target)
+		{
+			auto types = archetype->Types();
+			const auto it = std::ranges::upper_bound(types, type->type_index, {}, &ComponentTypeInfo::type_index);
+			types.insert(it, type);
+			target = GetArchetype(std::move(types));
+		}
+		return target;
+	}
+
+	Archetype* ArchetypeWorld::GetRemoveTarget(Archetype* archetype, size_t type_index)
+	{
+		auto& edges = archetype->remove_edges;
+		edges.resize(std::max(edges.size(), type_index + 1), nullptr);
+
+		auto& target = edges[type_index];
+		if (!target)
+		{
+			auto types = archetype->Types();
+			std::erase_if(types, [type_index](const auto* type) { return type->type_index == type_index; });
+			target = GetArchetype(std::move(types));
+		}
+		return target;
+	}
+
+	void ArchetypeWorld::MoveEntity(Entity entity, Archetype* target, ArchetypeRow pos)
+	{
+		auto& record = records[entity.Index()];
+		auto* source = record.archetype;
+
+		const auto& types = source->Types();
+		for (size_t col = 0; col < types.size(); ++col)
+		{
+			const auto target_col = target->ColumnOf(types[col]->type_index);
+			if (target_col >= 0) {
+				types[col]->move_construct(target->Component(pos, target_col), source->Component(record.pos, static_cast<int>(col)));
+			}
+		}
+
+		// destroys moved-from components along with the ones absent in target
+		if (const auto moved = source->Erase(record.pos)) {
+			records[moved.Index()].pos = record.pos;
+		}
+
+		record.archetype = target;
+		record.pos = pos;
+	}
+
+	bool ArchetypeWorld::RemoveComponent(Entity entity, size_t type_index)
+	{
+		assert(HasEntity(entity));
+
+		auto* archetype = records[entity.Index()].archetype;
+		if (!archetype->Has(type_index)) return false;
+
+		// archetype with fewer components always fits, because this one does
+		auto* target = GetRemoveTarget(archetype, type_index);
+		assert(target);
+		MoveEntity(entity, target, target->Push(entity));
+		return true;
+	}
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "Archetype.h"
+#include "View.h"
+
+#include <map>
+#include <array>
+#include <tuple>
+#include <cassert>
+
+namespace Expanse::ecs
+{
+	/*
+	* Alternative world storage: entities with identical component sets share an archetype,
+	* components live in per-archetype chunked columns. Iteration streams linearly through
+	* chunks without per-entity lookups, at the cost of moving all components of the entity
+	* on every structural change.
+	*
+	* Implements core part of World interface, so both can be plugged into the same templated code.
+	* Adding or removing components and destroying entities from inside ForEach is not allowed.
+	*/
+	class ArchetypeWorld
+	{
+	public:
+		ArchetypeWorld();
+		~ArchetypeWorld() = default;
+
+		ArchetypeWorld(const ArchetypeWorld&) = delete;
+		ArchetypeWorld& operator=(const ArchetypeWorld&) = delete;
+
+		Entity CreateEntity();
+
+		void DestroyEntity(Entity entity);
+
+		template<typename EntityRange>
+		void DestroyEntities(EntityRange&& entities)
+		{
+			for (auto ent : entities) {
+				DestroyEntity(ent);
+			}
+		}
+
+		bool HasEntity(Entity entity) const;
+
+		// Returns nullptr if entity's components with the new one don't fit into a chunk
+		template<typename Comp, typename... Args>
+		Comp* AddComponent(Entity entity, Args&&... args)
+		{
+			assert(HasEntity(entity));
+			assert(!HasComponent<Comp>(entity));
+
+			auto& record = records[entity.Index()];
+			auto* target = GetAddTarget(record.archetype, ComponentTypeInfo::Get<Comp>());
+			if (!target)
+				return nullptr;
+
+			const auto column = target->ColumnOf(ComponentTypeIndex<Comp>);
+
+			// new component is constructed before the rest are moved, so args may refer to them
+			const auto pos = target->Push(entity);
+			void* ptr = target->Component(pos, column);
+			if constexpr (std::is_constructible_v<Comp, Args...>) {
+				std::construct_at(static_cast<Comp*>(ptr), std::forward<Args>(args)...);
+			} else {
+				new(ptr) Comp{ std::forward<Args>(args)... };
+			}
+
+			MoveEntity(entity, target, pos);
+			return static_cast<Comp*>(ptr);
+		}
+
+		template<typename Comp>
+		bool RemoveComponent(Entity entity)
+		{
+			return RemoveComponent(entity, ComponentTypeIndex<Comp>);
+		}
+
+		template<typename Comp>
+		Comp* GetComponent(Entity entity)
+		{
+			return GetComponentImpl<Comp>(entity);
+		}
+
+		template<typename Comp>
+		const Comp* GetComponent(Entity entity) const
+		{
+			return GetComponentImpl<Comp>(entity);
+		}
+
+		template<typename... Comps>
+		auto GetComponents(Entity entity)
+		{
+			return std::make_tuple((GetComponent<Comps>(entity))...);
+		}
+
+		template<typename Comp>
+		bool HasComponent(Entity entity) const
+		{
+			assert(HasEntity(entity));
+			return records[entity.Index()].archetype->Has(ComponentTypeIndex<Comp>);
+		}
+
+		// Number of archetypes created so far, including the empty one
+		size_t ArchetypesCount() const noexcept { return archetypes.size(); }
+
+		/*
+		* Calls func(entity, comps&...) for each entity having all of the listed components,
+		* Without<...> arguments exclude components, same as World::ForEach.
+		*/
+		template<typename... Args, typename Func>
+		void ForEach(Func func)
+		{
+			ForEachImpl(func, typename details::QueryArgs<Args...>::Included{}, typename details::QueryArgs<Args...>::Excluded{});
+		}
+
+	private:
+		struct EntityRecord
+		{
+			EntityRecord(size_t index) : entity(index) {}
+
+			// for free slots stores index of the next free slot and version of the next entity
+			Entity entity;
+			Archetype* archetype = nullptr;
+			ArchetypeRow pos;
+		};
+
+		std::vector<EntityRecord> records;
+		std::map<std::vector<size_t>, std::unique_ptr<Archetype>> archetypes;
+		Archetype* empty_archetype = nullptr;
+
+		static constexpr auto NullIndex = Entity::MaxIndex;
+		Entity::BaseType free_head = NullIndex;
+
+		// Returns nullptr if archetype of these types is invalid
+		Archetype* GetArchetype(std::vector<const ComponentTypeInfo*> types);
+		Archetype* GetAddTarget(Archetype* archetype, const ComponentTypeInfo* type);
+		Archetype* GetRemoveTarget(Archetype* archetype, size_t type_index);
+
+		// Moves components of the entity, which are present in target, into already allocated row
+		void MoveEntity(Entity entity, Archetype* target, ArchetypeRow pos);
+
+		bool RemoveComponent(Entity entity, size_t type_index);
+
+		template<typename Comp>
+		Comp* GetComponentImpl(Entity entity) const
+		{
+			assert(HasEntity(entity));
+
+			const auto& record = records[entity.Index()];
+			const auto column = record.archetype->ColumnOf(ComponentTypeIndex<Comp>);
+			return (column >= 0) ? static_cast<Comp*>(record.archetype->Component(record.pos, column)) : nullptr;
+		}
+
+		template<typename Func, typename... Comps, typename... Excluded>
+		void ForEachImpl(Func& func, details::TypeList<Comps...>, details::TypeList<Excluded...>)
+		{
+			static_assert(sizeof...(Comps) > 0, "ForEach must include at least one component type");
+
+			for (auto& [signature, archetype] : archetypes)
+			{
+				if (archetype->Size() == 0) continue;
+
+				const std::array<int, sizeof...(Comps)> columns{ archetype->ColumnOf(ComponentTypeIndex<std::remove_const_t<Comps>>)... };
+				const bool has_all = std::ranges::all_of(columns, [](int col) { return col >= 0; });
+				const bool excluded = (false || ... || archetype->Has(ComponentTypeIndex<std::remove_const_t<Excluded>>));
+				if (!has_all || excluded) continue;
+
+				ForEachInArchetype<Comps...>(*archetype, func, columns, std::index_sequence_for<Comps...>{});
+			}
+		}
+
+		template<typename... Comps, typename Func, typename Columns, size_t... I>
+		static void ForEachInArchetype(const Archetype& archetype, Func& func, const Columns& columns, std::index_sequence<I...>)
+		{
+			for (const auto& chunk : archetype.Chunks())
+			{
+				const Entity* ents = archetype.Entities(chunk);
+				const auto arrays = std::make_tuple(static_cast<Comps*>(archetype.Column(chunk, columns[I]))...);
+
+				for (size_t row = 0; row < chunk.count; ++row) {
+					func(ents[row], std::get<I>(arrays)[row]...);
+				}
+			}
+		}
+	};
+}
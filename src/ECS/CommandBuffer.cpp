@@ -0,0 +1,106 @@
+#include "CommandBuffer.h"
+
+#include <atomic>
+
+namespace Expanse::ecs
+{
+	void CommandBuffer::Playback(World& world)
+	{
+		CreateEntities(world);
+		ApplyComponents(world);
+		DestroyEntities(world, destroyed);
+		Clear();
+	}
+
+	void CommandBuffer::CreateEntities(World& world)
+	{
+		created.clear();
+		for (uint32_t i = 0; i < pending_count; ++i) {
+			created.push_back(world.CreateEntity());
+		}
+	}
+
+	void CommandBuffer::ApplyComponents(World& world)
+	{
+		for (const auto type_index : used_types) {
+			commands[type_index]->Apply(world, created, scratch);
+		}
+	}
+
+	void CommandBuffer::Clear()
+	{
+		for (const auto type_index : used_types) {
+			commands[type_index]->Clear();
+		}
+		used_types.clear();
+		pending_count = 0;
+		destroyed.clear();
+	}
+
+	void CommandBuffer::DestroyEntities(World& world, std::vector<Entity>& entities)
+	{
+		if (entities.empty()) return;
+
+		std::ranges::sort(entities, {}, [](Entity entity) { return entity.Index(); });
+		const auto [first, last] = std::ranges::unique(entities);
+		entities.erase(first, last);
+		world.DestroyEntities(entities);
+	}
+
+	/*************************************************************************************************/
+
+	namespace
+	{
+		std::atomic<uint64_t> next_buffers_id = 1;
+	}
+
+	ThreadCommandBuffers::ThreadCommandBuffers()
+		: id(next_buffers_id++)
+	{}
+
+	CommandBuffer& ThreadCommandBuffers::Local()
+	{
+		struct LocalCache
+		{
+			uint64_t owner_id = 0;
+			CommandBuffer* buffer = nullptr;
+		};
+		thread_local LocalCache cache;
+
+		if (cache.owner_id != id)
+		{
+			const auto thread_id = std::this_thread::get_id();
+
+			std::scoped_lock lock(mutex);
+			auto itr = std::ranges::find(buffers, thread_id, [](const auto& buf) { return buf.first; });
+			if (itr == buffers.end()) {
+				itr = buffers.insert(buffers.end(), { thread_id, std::make_unique<CommandBuffer>() });
+			}
+
+			cache = { id, itr->second.get() };
+		}
+
+		return *cache.buffer;
+	}
+
+	void ThreadCommandBuffers::Playback(World& world)
+	{
+		std::scoped_lock lock(mutex);
+		for (auto& [thread_id, buffer] : buffers) {
+			buffer->CreateEntities(world);
+		}
+		for (auto& [thread_id, buffer] : buffers) {
+			buffer->ApplyComponents(world);
+		}
+
+		destroyed.clear();
+		for (auto& [thread_id, buffer] : buffers) {
+			destroyed.insert(destroyed.end(), buffer->destroyed.begin(), buffer->destroyed.end());
+		}
+		CommandBuffer::DestroyEntities(world, destroyed);
+
+		for (auto& [thread_id, buffer] : buffers) {
+			buffer->Clear();
+		}
+	}
+}
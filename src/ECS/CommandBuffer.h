@@ -0,0 +1,307 @@
+#pragma once
+
+#include "World.h"
+
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+namespace Expanse::ecs
+{
+	// Placeholder for entity created by CommandBuffer, only valid within the same buffer
+	struct PendingEntity
+	{
+		uint32_t index = 0;
+	};
+
+	/*
+	* Records structural changes, so that they can be applied after iteration is over.
+	* Memory is kept between playbacks, so a buffer living in a system doesn't allocate in steady state.
+	*
+	* Playback applies commands in fixed order, grouped by component type:
+	* created entities, removed components, added components, destroyed entities.
+	* Commands on the same component of the same entity collapse, so that the last recorded one wins,
+	* e.g. removing a component and adding it again replaces it.
+	*/
+	class CommandBuffer
+	{
+	public:
+		CommandBuffer() = default;
+		CommandBuffer(const CommandBuffer&) = delete;
+		CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+		// Entity is created on playback, placeholder can be used to add components to it
+		PendingEntity CreateEntity()
+		{
+			return { pending_count++ };
+		}
+
+		void DestroyEntity(Entity entity)
+		{
+			destroyed.push_back(entity);
+		}
+
+		template<typename Comp, typename... Args>
+		void AddComponent(Entity entity, Args&&... args)
+		{
+			GetCommands<Comp>().Add(entity, NullPending, std::forward<Args>(args)...);
+		}
+
+		template<typename Comp, typename... Args>
+		void AddComponent(PendingEntity entity, Args&&... args)
+		{
+			assert(entity.index < pending_count);
+			GetCommands<Comp>().Add(Entity{}, entity.index, std::forward<Args>(args)...);
+		}
+
+		template<typename Comp>
+		void RemoveComponent(Entity entity)
+		{
+			GetCommands<Comp>().Remove(entity);
+		}
+
+		bool Empty() const noexcept
+		{
+			return pending_count == 0 && destroyed.empty() && used_types.empty();
+		}
+
+		// Applies all recorded commands and clears the buffer
+		void Playback(World& world);
+
+	private:
+		friend class ThreadCommandBuffers;
+
+		static constexpr uint32_t NullPending = std::numeric_limits<uint32_t>::max();
+
+		// Recorded command, used to find the last one for every entity
+		struct Command
+		{
+			uint32_t pending = NullPending;
+			Entity::BaseType entity = 0;
+			uint32_t seq = 0;
+			uint32_t index = 0;		// in the list of adds or removes
+			bool add = false;
+		};
+
+		// Scratch memory, shared by commands of all types
+		struct CollapseBuffers
+		{
+			std::vector<Command> commands;
+			std::vector<uint32_t> kept_adds;
+			std::vector<uint32_t> kept_removes;
+		};
+
+		struct ComponentCommandsBase
+		{
+			virtual ~ComponentCommandsBase() = default;
+
+			virtual void Apply(World& world, const std::vector<Entity>& created, CollapseBuffers& scratch) = 0;
+			virtual void Clear() = 0;
+		};
+
+		template<typename Comp>
+		struct ComponentCommands final : ComponentCommandsBase
+		{
+			// added components are kept apart from their entities, so that they are added in one batch
+			std::vector<Entity> add_entities;
+			std::vector<uint32_t> add_pending;
+			std::vector<uint32_t> add_seq;
+			std::vector<Comp> add_comps;
+
+			std::vector<Entity> removes;
+			std::vector<uint32_t> remove_seq;
+
+			uint32_t next_seq = 0;
+
+			// constructed the same way as World::AddComponent does it
+			template<typename... Args>
+			void Add(Entity entity, uint32_t pending, Args&&... args)
+			{
+				if constexpr (std::is_constructible_v<Comp, Args...>) {
+					add_comps.emplace_back(std::forward<Args>(args)...);
+				} else {
+					add_comps.push_back({ std::forward<Args>(args)... });
+				}
+				add_entities.push_back(entity);
+				add_pending.push_back(pending);
+				add_seq.push_back(next_seq++);
+			}
+
+			void Remove(Entity entity)
+			{
+				removes.push_back(entity);
+				remove_seq.push_back(next_seq++);
+			}
+
+			void Apply(World& world, const std::vector<Entity>& created, CollapseBuffers& scratch) override
+			{
+				Collapse(scratch);
+
+				// entity, which is in both lists, had its component removed and then added again
+				if (!removes.empty()) {
+					world.RemoveComponents<Comp>(removes);
+				}
+
+				if (add_comps.empty()) return;
+
+				for (size_t i = 0; i < add_entities.size(); ++i)
+				{
+					if (add_pending[i] != NullPending) {
+						add_entities[i] = created[add_pending[i]];
+					}
+				}
+				world.AddComponents<Comp>(add_entities, add_comps);
+			}
+
+			// Keeps only the last add of every entity and removes, which come before it or are the last command
+			void Collapse(CollapseBuffers& scratch)
+			{
+				if (add_comps.size() + removes.size() < 2) return;
+
+				auto& commands = scratch.commands;
+				commands.clear();
+				for (uint32_t i = 0; i < add_comps.size(); ++i) {
+					commands.push_back({ add_pending[i], add_entities[i].Value(), add_seq[i], i, true });
+				}
+				for (uint32_t i = 0; i < removes.size(); ++i) {
+					commands.push_back({ NullPending, removes[i].Value(), remove_seq[i], i, false });
+				}
+				std::ranges::sort(commands, {}, [](const Command& cmd) { return std::tuple{ cmd.pending, cmd.entity, cmd.seq }; });
+
+				scratch.kept_adds.clear();
+				scratch.kept_removes.clear();
+				for (auto first = commands.begin(); first != commands.end();)
+				{
+					const auto last = std::find_if(first, commands.end(), [first](const Command& cmd) {
+						return cmd.pending != first->pending || cmd.entity != first->entity;
+					});
+
+					const auto& final_cmd = *(last - 1);
+					if (final_cmd.add)
+					{
+						scratch.kept_adds.push_back(final_cmd.index);
+
+						const auto remove = std::find_if(first, last, [](const Command& cmd) { return !cmd.add; });
+						if (remove != last) {
+							scratch.kept_removes.push_back(remove->index);
+						}
+					}
+					else
+					{
+						scratch.kept_removes.push_back(final_cmd.index);
+					}
+					first = last;
+				}
+
+				// batches keep recording order
+				if (scratch.kept_adds.size() != add_comps.size())
+				{
+					std::ranges::sort(scratch.kept_adds);
+					for (size_t i = 0; i < scratch.kept_adds.size(); ++i)
+					{
+						const auto src = scratch.kept_adds[i];
+						add_entities[i] = add_entities[src];
+						add_pending[i] = add_pending[src];
+						if (i != src) {
+							add_comps[i] = std::move(add_comps[src]);
+						}
+					}
+					add_entities.resize(scratch.kept_adds.size());
+					add_pending.resize(scratch.kept_adds.size());
+					add_comps.erase(add_comps.begin() + static_cast<ptrdiff_t>(scratch.kept_adds.size()), add_comps.end());
+				}
+
+				if (scratch.kept_removes.size() != removes.size())
+				{
+					std::ranges::sort(scratch.kept_removes);
+					for (size_t i = 0; i < scratch.kept_removes.size(); ++i) {
+						removes[i] = removes[scratch.kept_removes[i]];
+					}
+					removes.resize(scratch.kept_removes.size());
+				}
+			}
+
+			void Clear() override
+			{
+				add_entities.clear();
+				add_pending.clear();
+				add_seq.clear();
+				add_comps.clear();
+				removes.clear();
+				remove_seq.clear();
+				next_seq = 0;
+			}
+		};
+
+		// indexed by component type, kept between playbacks to reuse their memory
+		std::vector<std::unique_ptr<ComponentCommandsBase>> commands;
+		// component types recorded since the last playback
+		std::vector<size_t> used_types;
+
+		uint32_t pending_count = 0;
+		std::vector<Entity> created;
+		std::vector<Entity> destroyed;
+
+		CollapseBuffers scratch;
+
+		// Playback steps, ThreadCommandBuffers runs each of them for all buffers before the next one
+		void CreateEntities(World& world);
+		void ApplyComponents(World& world);
+		void Clear();
+
+		// Destroys listed entities, each of them once
+		static void DestroyEntities(World& world, std::vector<Entity>& entities);
+
+		template<typename Comp>
+		ComponentCommands<Comp>& GetCommands()
+		{
+			const auto type_index = ComponentTypeIndex<Comp>;
+
+			commands.resize(std::max(commands.size(), type_index + 1));
+
+			auto& cmds = commands[type_index];
+			if (!cmds) {
+				cmds = std::make_unique<ComponentCommands<Comp>>();
+			}
+
+			if (std::ranges::find(used_types, type_index) == used_types.end()) {
+				used_types.push_back(type_index);
+			}
+
+			return static_cast<ComponentCommands<Comp>&>(*cmds);
+		}
+	};
+
+	/*
+	* Command buffers for systems, which record commands from several threads at once,
+	* e.g. from ParallelForEach: every thread gets its own buffer, so recording doesn't lock.
+	*
+	* Each playback step runs for all buffers before the next one, so destroying an entity in one thread
+	* and changing its components in another one gives the same result, whichever buffer goes first.
+	* Which thread processes which entities depends on the scheduler, so commands on the same component
+	* of the same entity must not be recorded from different threads, their order is undefined.
+	*/
+	class ThreadCommandBuffers
+	{
+	public:
+		ThreadCommandBuffers();
+
+		ThreadCommandBuffers(const ThreadCommandBuffers&) = delete;
+		ThreadCommandBuffers& operator=(const ThreadCommandBuffers&) = delete;
+
+		// Buffer of the calling thread
+		CommandBuffer& Local();
+
+		void Playback(World& world);
+
+	private:
+		// unique among all instances, so that thread local cache can't match destroyed instance
+		const uint64_t id;
+
+		std::mutex mutex;
+		std::vector<std::pair<std::thread::id, std::unique_ptr<CommandBuffer>>> buffers;
+
+		// entities destroyed by all buffers, the same one could be destroyed from several threads
+		std::vector<Entity> destroyed;
+	};
+}
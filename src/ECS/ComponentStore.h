@@ -1,32 +1,633 @@
 #pragma once
 
 #include "Entity.h"
+#include "EntityStore.h"
+#include "PagedVector.h"
+#include "SnapshotTraits.h"
+#include "Stats.h"
+
+#include "Utils/BinaryStream.h"
 
 #include <vector>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
+#include <limits>
+#include <functional>
+#include <bit>
+#include <utility>
+#include <span>
 
 namespace Expanse::ecs
 {
-	struct ComponentStoreBase
+	/*
+	* Sparse set of entities. Sparse array is keyed by entity index and split into lazily
+	* allocated pages, it maps entity to its position in dense array of entities.
+	*/
+	class SparseSet
+	{
+	public:
+		bool Contains(Entity entity) const noexcept
+		{
+			const auto comp_idx = IndexOf(entity);
+			return (comp_idx != NullComponentIndex) && (entities[comp_idx] == entity);
+		}
+
+		ComponentIndex IndexOf(Entity entity) const noexcept
+		{
+			const auto [page, offset] = SparsePos(entity);
+			return (page < sparse.size() && sparse[page]) ? sparse[page][offset] : NullComponentIndex;
+		}
+
+		size_t Size() const noexcept { return entities.size(); }
+
+		// Memory allocated for sparse pages and the table of them
+		size_t SparseBytes() const noexcept
+		{
+			const auto pages = std::ranges::count_if(sparse, [](const auto& page) { return page != nullptr; });
+			return static_cast<size_t>(pages) * SparsePageSize * sizeof(ComponentIndex) + sparse.capacity() * sizeof(sparse[0]);
+		}
+
+		std::vector<Entity> entities;
+
+	protected:
+		static constexpr size_t SparsePageSize = 4096;
+
+		ComponentIndex Insert(Entity entity)
+		{
+			assert(!Contains(entity));
+
+			entities.push_back(entity);
+			const auto idx = static_cast<ComponentIndex>(entities.size() - 1);
+			SetIndex(entity, idx);
+			return idx;
+		}
+
+		// Moves last entity into position of the erased one
+		void Erase(Entity entity)
+		{
+			assert(Contains(entity));
+
+			EraseAt(IndexOf(entity));
+		}
+
+		void EraseAt(ComponentIndex idx)
+		{
+			const auto entity = entities[idx];
+			const auto last = static_cast<ComponentIndex>(entities.size() - 1);
+			if (idx != last)
+			{
+				entities[idx] = entities[last];
+				SetIndex(entities[idx], idx);
+			}
+
+			entities.pop_back();
+			ResetIndex(entity);
+		}
+
+		void SwapAt(ComponentIndex idx1, ComponentIndex idx2)
+		{
+			std::swap(entities[idx1], entities[idx2]);
+			SetIndex(entities[idx1], idx1);
+			SetIndex(entities[idx2], idx2);
+		}
+
+		void SetIndex(Entity entity, ComponentIndex comp_idx)
+		{
+			const auto [page, offset] = SparsePos(entity);
+			if (page >= sparse.size()) {
+				sparse.resize(page + 1);
+			}
+			if (!sparse[page]) {
+				sparse[page] = std::make_unique<ComponentIndex[]>(SparsePageSize);
+				std::fill_n(sparse[page].get(), SparsePageSize, NullComponentIndex);
+			}
+			sparse[page][offset] = comp_idx;
+		}
+
+		void ResetIndex(Entity entity) noexcept
+		{
+			const auto [page, offset] = SparsePos(entity);
+			sparse[page][offset] = NullComponentIndex;
+		}
+
+	private:
+		std::vector<std::unique_ptr<ComponentIndex[]>> sparse;
+
+		static std::pair<size_t, size_t> SparsePos(Entity entity) noexcept
+		{
+			const auto idx = static_cast<size_t>(entity.Index());
+			return { idx / SparsePageSize, idx % SparsePageSize };
+		}
+	};
+
+	/* Sparse set without any payload */
+	class EntitySet : public SparseSet
+	{
+	public:
+		using SparseSet::Insert;
+		using SparseSet::Erase;
+		using SparseSet::SwapAt;
+	};
+
+	/*
+	* Full sort orders positions with std::sort and moves every element at most once,
+	* incremental one is an insertion sort, which is linear when only few elements are out of order.
+	*/
+	enum class SortMode { Full, Incremental };
+
+	namespace details
+	{
+		/*
+		* Sorts positions [begin, end) of one or several parallel arrays in place:
+		* less(i, j) compares elements at positions i and j, swap(i, j) swaps them in all arrays.
+		*/
+		template<typename Less, typename Swap>
+		void SortPositions(size_t begin, size_t end, SortMode mode, Less less, Swap swap)
+		{
+			if (end - begin < 2) return;
+
+			if (mode == SortMode::Incremental)
+			{
+				// too many elements out of order would make insertion sort quadratic
+				size_t descents = 0;
+				for (size_t i = begin + 1; i < end; ++i) {
+					descents += less(static_cast<ComponentIndex>(i), static_cast<ComponentIndex>(i - 1)) ? 1 : 0;
+				}
+				if (descents == 0) return;
+
+				if (descents * 16 <= end - begin)
+				{
+					for (size_t i = begin + 1; i < end; ++i)
+					{
+						for (auto j = static_cast<ComponentIndex>(i); j > begin && less(j, j - 1); --j) {
+							swap(j, j - 1);
+						}
+					}
+					return;
+				}
+			}
+
+			// order[k] is position of the element, which goes to begin + k
+			std::vector<ComponentIndex> order(end - begin);
+			for (size_t k = 0; k < order.size(); ++k) {
+				order[k] = static_cast<ComponentIndex>(begin + k);
+			}
+			std::ranges::sort(order, less);
+
+			// every cycle of the permutation is applied with swaps along it
+			std::vector<bool> placed(order.size(), false);
+			for (size_t start = 0; start < order.size(); ++start)
+			{
+				if (placed[start]) continue;
+
+				for (size_t k = start;;)
+				{
+					placed[k] = true;
+					const size_t next = order[k] - begin;
+					if (next == start) break;
+
+					swap(static_cast<ComponentIndex>(begin + k), static_cast<ComponentIndex>(begin + next));
+					k = next;
+				}
+			}
+		}
+	}
+
+	/* Receives notifications about entities added to or removed from component store */
+	struct StoreListener
+	{
+		virtual ~StoreListener() = default;
+
+		// Called after component was added
+		virtual void OnAdd(Entity entity) = 0;
+
+		// Called before component is removed
+		virtual void OnRemove(Entity entity) = 0;
+	};
+
+	/*
+	* Observers are callbacks registered for a component type, which receive batches of entities:
+	* Add ones after components were added, Remove ones before components are removed.
+	* Unlike listeners, they are called once per batch operation, e.g. CreateEntities or RemoveComponents.
+	* Observers must not add or remove components of the observed type.
+	*/
+	enum class ObserverEvent { Add, Remove };
+	using ObserverId = uint32_t;
+	using ObserverFunc = std::function<void(std::span<const Entity>)>;
+
+	/*
+	* World tick, at which component was added or last accessed for writing.
+	* Ticks start from 1, so that 0 can be used as "since the beginning".
+	*/
+	using ChangeTick = uint32_t;
+
+	/*
+	* Type-independent part of component store: sparse set of entities,
+	* which is kept in sync with dense arrays of components and their change ticks.
+	*/
+	struct ComponentStoreBase : SparseSet
 	{
 		virtual ~ComponentStoreBase() = default;
 
-		virtual Entity Remove(ComponentIndex comp_idx) = 0;
+		// Removes component of the entity, returns false if entity had none
+		bool Remove(Entity entity)
+		{
+			if (!Contains(entity)) return false;
+
+			NotifyObservers(ObserverEvent::Remove, { &entity, 1 });
+			RemoveNotified(entity);
+			return true;
+		}
+
+		/*
+		* Removes components of all listed entities, which must have them, duplicates are allowed.
+		* Positions are processed in descending order, so that the store is walked once from the end
+		* and elements at positions not processed yet are never moved.
+		*/
+		void RemoveMany(const std::vector<Entity>& batch)
+		{
+			if (listeners.empty() && observers.empty())
+			{
+				ForEachPositionDescending(batch, [this](ComponentIndex idx) { RemoveAt(idx); });
+			}
+			else
+			{
+				// listeners may reorder the store, so entities are removed one by one
+				std::vector<Entity> sorted;
+				sorted.reserve(batch.size());
+				ForEachPositionDescending(batch, [this, &sorted](ComponentIndex idx) { sorted.push_back(entities[idx]); });
+
+				NotifyObservers(ObserverEvent::Remove, sorted);
+				for (const auto entity : sorted) {
+					RemoveNotified(entity);
+				}
+			}
+		}
+
+		// Swaps positions of two components along with their entities
+		void Swap(ComponentIndex idx1, ComponentIndex idx2)
+		{
+			if (idx1 == idx2) return;
+
+			SwapAt(idx1, idx2);
+			SwapComponents(idx1, idx2);
+			std::swap(added_ticks[idx1], added_ticks[idx2]);
+			std::swap(changed_ticks[idx1], changed_ticks[idx2]);
+		}
+
+		bool AddedSince(ComponentIndex idx, ChangeTick since) const noexcept { return added_ticks[idx] > since; }
+		bool ChangedSince(ComponentIndex idx, ChangeTick since) const noexcept { return changed_ticks[idx] > since; }
+
+		// Store-wide checks, so that queries can skip untouched stores without visiting entities
+		bool AnyAddedSince(ChangeTick since) const noexcept { return last_added_tick > since; }
+		bool AnyChangedSince(ChangeTick since) const noexcept { return last_changed_tick > since; }
+
+		void MarkChanged(ComponentIndex idx, ChangeTick tick) noexcept
+		{
+			changed_ticks[idx] = tick;
+			last_changed_tick = tick;
+		}
+
+		// Only updates store-wide tick, component ticks are expected to be set with MarkChangedAt
+		void MarkStoreChanged(ChangeTick tick) noexcept { last_changed_tick = tick; }
+		void MarkChangedAt(ComponentIndex idx, ChangeTick tick) noexcept { changed_ticks[idx] = tick; }
+
+		// Allocates memory for at least capacity components, so that adding them doesn't allocate
+		void Reserve(size_t capacity)
+		{
+			ReserveComponents(capacity);
+			added_ticks.reserve(capacity);
+			changed_ticks.reserve(capacity);
+		}
+
+		// Frees memory of removed components
+		void ShrinkToFit()
+		{
+			ShrinkComponents();
+			added_ticks.shrink_to_fit();
+			changed_ticks.shrink_to_fit();
+		}
+
+		/*
+		* Whether component pages emptied by removal are returned to the page allocator right away.
+		* One spare page is kept, so that adding and removing around page boundary doesn't thrash.
+		*/
+		enum class ShrinkPolicy { KeepPages, ReleaseEmptyPages };
+		void SetShrinkPolicy(ShrinkPolicy policy) { shrink_policy = policy; }
+
+		// Memory and churn of the store, name is left empty
+		StoreStats GetStats() const
+		{
+			const auto comps = GetComponentsMemory();
+
+			// every live component also has an entity, two ticks and a sparse entry
+			const auto used = comps.used + Size() * (sizeof(Entity) + 2 * sizeof(ChangeTick) + sizeof(ComponentIndex));
+			const auto allocated = comps.allocated + SparseBytes()
+				+ entities.capacity() * sizeof(Entity)
+				+ (added_ticks.capacity() + changed_ticks.capacity()) * sizeof(ChangeTick);
+
+			StoreStats stats;
+			stats.size = Size();
+			stats.capacity = comps.capacity;
+			stats.bytes_used = used;
+			stats.bytes_wasted = allocated - used;
+			stats.bytes_cached = comps.cached;
+			stats.frame_adds = last_frame_adds;
+			stats.frame_removes = last_frame_removes;
+			return stats;
+		}
+
+		// Starts counting adds and removes of the next frame
+		void RollFrameCounters() noexcept
+		{
+			last_frame_adds = std::exchange(frame_adds, 0);
+			last_frame_removes = std::exchange(frame_removes, 0);
+		}
+
+		// Only stores of components, which opted in with SnapshotComponent, are saved
+		virtual bool IsSerializable() const noexcept = 0;
+
+		// Expected size of data written by Write, so that writer can allocate it at once
+		size_t EstimateWriteSize() const
+		{
+			return sizeof(uint64_t) + Size() * sizeof(Entity) + EstimateComponentsSize();
+		}
+
+		// Writes entities and components as contiguous blocks
+		void Write(BinaryWriter& out) const
+		{
+			out.Write<uint64_t>(Size());
+			out.WriteBytes(entities.data(), entities.size() * sizeof(Entity));
+			WriteComponents(out);
+		}
+
+		/*
+		* Fills empty store with data written by Write, components are marked as added at tick.
+		* Returns false if data is corrupted, store is left in unspecified state then.
+		*/
+		bool Read(BinaryReader& in, ChangeTick tick, std::span<const EntityStore> entity_table)
+		{
+			assert(Size() == 0);
+
+			const auto count = in.Read<uint64_t>();
+			if (count > in.Remaining() / sizeof(Entity)) return false;
+
+			entities.resize(static_cast<size_t>(count));
+			in.ReadBytes(entities.data(), entities.size() * sizeof(Entity));
+
+			// every entity must be live in the restored table, with the same version, and only once in the store
+			for (size_t i = 0; i < entities.size(); ++i)
+			{
+				const auto idx = static_cast<size_t>(entities[i].Index());
+				if (idx >= entity_table.size() || entity_table[idx].entity != entities[i] || Contains(entities[i]))
+				{
+					for (size_t j = 0; j < i; ++j) {
+						ResetIndex(entities[j]);
+					}
+					entities.clear();
+					return false;
+				}
+				SetIndex(entities[i], static_cast<ComponentIndex>(i));
+			}
+
+			if (!ReadComponents(in, entities.size())) return false;
+
+			added_ticks.assign(entities.size(), tick);
+			changed_ticks.assign(entities.size(), tick);
+			frame_adds += entities.size();
+			if (!entities.empty()) {
+				last_added_tick = last_changed_tick = tick;
+			}
+
+			// copy, because owning groups reorder the store
+			if (!listeners.empty() || !observers.empty())
+			{
+				const auto added = entities;
+				for (const auto entity : added) {
+					NotifyAdd(entity);
+				}
+				NotifyObservers(ObserverEvent::Add, added);
+			}
+			return true;
+		}
+
+		void AddListener(StoreListener* listener) { listeners.push_back(listener); }
+		void RemoveListener(StoreListener* listener) { std::erase(listeners, listener); }
+
+		ObserverId AddObserver(ObserverEvent event, ObserverFunc func)
+		{
+			observers.push_back({ ++last_observer_id, event, std::move(func) });
+			return last_observer_id;
+		}
+
+		// Must not be called from an observer
+		void RemoveObserver(ObserverId id)
+		{
+			std::erase_if(observers, [id](const Observer& observer) { return observer.id == id; });
+		}
+
+		// Group, which keeps its entities in the prefix of this store, at most one per store
+		StoreListener* owner = nullptr;
+		// Length of that prefix, it is maintained by the owner
+		size_t owned_size = 0;
+
+	protected:
+		void InsertTicks(ChangeTick tick)
+		{
+			++frame_adds;
+			added_ticks.push_back(tick);
+			changed_ticks.push_back(tick);
+			last_added_tick = tick;
+			last_changed_tick = tick;
+		}
+
+		// Only notifies listeners, observers are notified once per batch
+		void NotifyAdd(Entity entity)
+		{
+			for (auto* listener : listeners) {
+				listener->OnAdd(entity);
+			}
+		}
+
+		void NotifyObservers(ObserverEvent event, std::span<const Entity> batch)
+		{
+			if (batch.empty()) return;
+
+			for (const auto& observer : observers)
+			{
+				if (observer.event == event) {
+					observer.func(batch);
+				}
+			}
+		}
+
+		// Moves last component into position of the erased one, same as SparseSet::Erase does for entities
+		virtual void EraseComponent(Entity entity, ComponentIndex idx) = 0;
+		virtual void SwapComponents(ComponentIndex idx1, ComponentIndex idx2) = 0;
+		virtual void ReserveComponents(size_t capacity) = 0;
+		virtual void ShrinkComponents() = 0;
+		virtual void WriteComponents(BinaryWriter& out) const = 0;
+		virtual size_t EstimateComponentsSize() const = 0;
+
+		struct ComponentsMemory
+		{
+			size_t capacity = 0;	// number of components, which fit into allocated memory
+			size_t used = 0;		// bytes used by live components
+			size_t allocated = 0;
+			size_t cached = 0;		// free pages kept by the page allocator of the type, shared by all stores of it
+		};
+		virtual ComponentsMemory GetComponentsMemory() const noexcept = 0;
+		// Appends count components, which are in the same order as entities
+		virtual bool ReadComponents(BinaryReader& in, size_t count) = 0;
+
+		ShrinkPolicy shrink_policy = ShrinkPolicy::KeepPages;
+
+	private:
+		std::vector<StoreListener*> listeners;
+
+		struct Observer
+		{
+			ObserverId id;
+			ObserverEvent event;
+			ObserverFunc func;
+		};
+		std::vector<Observer> observers;
+		ObserverId last_observer_id = 0;
+
+		// Removes component after observers were notified
+		void RemoveNotified(Entity entity)
+		{
+			// listeners may reorder the store, so position is taken afterwards
+			for (auto* listener : listeners) {
+				listener->OnRemove(entity);
+			}
+
+			RemoveAt(IndexOf(entity));
+		}
+
+		template<typename Func>
+		void ForEachPositionDescending(const std::vector<Entity>& batch, Func func)
+		{
+			// few positions are just sorted, otherwise bitmap of positions is cheaper than sorting
+			if (batch.size() * 64 < Size())
+			{
+				std::vector<ComponentIndex> indices;
+				indices.reserve(batch.size());
+				for (const auto entity : batch)
+				{
+					assert(Contains(entity));
+					indices.push_back(IndexOf(entity));
+				}
+				std::ranges::sort(indices, std::greater{});
+				indices.erase(std::ranges::unique(indices).begin(), indices.end());
+
+				for (const auto idx : indices) {
+					func(idx);
+				}
+				return;
+			}
+
+			std::vector<uint64_t> marks((Size() + 63) / 64, 0);
+			for (const auto entity : batch)
+			{
+				assert(Contains(entity));
+				const auto idx = static_cast<size_t>(IndexOf(entity));
+				marks[idx / 64] |= uint64_t{ 1 } << (idx % 64);
+			}
+
+			for (size_t word = marks.size(); word-- > 0;)
+			{
+				for (auto bits = marks[word]; bits != 0;)
+				{
+					const auto bit = 63 - std::countl_zero(bits);
+					bits &= ~(uint64_t{ 1 } << bit);
+					func(static_cast<ComponentIndex>(word * 64 + bit));
+				}
+			}
+		}
+
+		void RemoveAt(ComponentIndex idx)
+		{
+			const auto entity = entities[idx];
+			EraseAt(idx);
+			EraseComponent(entity, idx);
+
+			added_ticks[idx] = added_ticks.back();
+			changed_ticks[idx] = changed_ticks.back();
+			added_ticks.pop_back();
+			changed_ticks.pop_back();
+
+			++frame_removes;
+		}
+
+		// parallel to entities
+		std::vector<ChangeTick> added_ticks;
+		std::vector<ChangeTick> changed_ticks;
+
+		ChangeTick last_added_tick = 0;
+		ChangeTick last_changed_tick = 0;
+
+		size_t frame_adds = 0;
+		size_t frame_removes = 0;
+		size_t last_frame_adds = 0;
+		size_t last_frame_removes = 0;
 	};
 
 	template<class Comp>
 	class ComponentStore : public ComponentStoreBase
 	{
 	public:
+		// Returns pointer to the new component, position is only known after listeners were notified
 		template<class... Args>
-		ComponentIndex Create(Entity entity, Args&&... args)
+		Comp* Create(Entity entity, ChangeTick tick, Args&&... args)
 		{
-			if constexpr (std::is_constructible_v<Comp, Args...>) {
-				components.emplace_back(std::forward<Args>(args)...);
-			} else {
-				components.push_back({ std::forward<Args>(args)... });
+			assert(!Contains(entity));
+
+			components.emplace_back(std::forward<Args>(args)...);
+			Insert(entity);
+			InsertTicks(tick);
+
+			NotifyAdd(entity);
+			NotifyObservers(ObserverEvent::Add, { &entity, 1 });
+			return Get(IndexOf(entity));
+		}
+
+		// Adds copies of comp to all entities in batch, observers are notified once afterwards
+		void CreateMany(std::span<const Entity> batch, ChangeTick tick, const Comp& comp)
+		{
+			Reserve(Size() + batch.size());
+			for (const auto entity : batch)
+			{
+				assert(!Contains(entity));
+
+				components.emplace_back(comp);
+				Insert(entity);
+				InsertTicks(tick);
+
+				NotifyAdd(entity);
 			}
-			entities.push_back(entity);
-			return static_cast<ComponentIndex>(entities.size() - 1);
+			NotifyObservers(ObserverEvent::Add, batch);
+		}
+
+		// Moves comps[i] to batch[i], observers are notified once afterwards
+		void CreateMany(std::span<const Entity> batch, ChangeTick tick, std::span<Comp> comps)
+		{
+			assert(batch.size() == comps.size());
+
+			Reserve(Size() + batch.size());
+			for (size_t i = 0; i < batch.size(); ++i)
+			{
+				assert(!Contains(batch[i]));
+
+				components.emplace_back(std::move(comps[i]));
+				Insert(batch[i]);
+				InsertTicks(tick);
+
+				NotifyAdd(batch[i]);
+			}
+			NotifyObservers(ObserverEvent::Add, batch);
 		}
 
 		Comp* Get(ComponentIndex comp_idx) {
@@ -37,39 +638,208 @@ namespace Expanse::ecs
 			return &components[comp_idx];
 		}
 
-		const std::vector<Comp>& GetAll() const {
+		Comp* Find(Entity entity) {
+			return Contains(entity) ? &components[IndexOf(entity)] : nullptr;
+		}
+
+		const Comp* Find(Entity entity) const {
+			return Contains(entity) ? &components[IndexOf(entity)] : nullptr;
+		}
+
+		const PagedVector<Comp>& GetAll() const {
 			return components;
 		}
 
-		Entity Remove(ComponentIndex comp_idx) override
+		/*
+		* Sorts components in place with compare(const Comp&, const Comp&), entities and change ticks move along.
+		* Prefix owned by a group is left as is, it has to be sorted through the group.
+		*/
+		template<typename Compare>
+		void Sort(Compare compare, SortMode mode = SortMode::Full)
 		{
-			assert(!components.empty());
+			details::SortPositions(owned_size, Size(), mode,
+				[this, &compare](ComponentIndex idx1, ComponentIndex idx2) { return compare(std::as_const(components[idx1]), std::as_const(components[idx2])); },
+				[this](ComponentIndex idx1, ComponentIndex idx2) { Swap(idx1, idx2); });
+		}
+
+		static constexpr size_t PageSize = PagedVector<Comp>::PageSize;
+
+		static_assert(!SnapshotComponent<Comp> || BinarySerializable<Comp>, "Snapshot component must be BinarySerializable");
 
-			const auto idx = static_cast<size_t>(comp_idx);
+		bool IsSerializable() const noexcept override { return SnapshotComponent<Comp>; }
+
+	protected:
+		void EraseComponent(Entity, ComponentIndex idx) override
+		{
 			const auto last = components.size() - 1;
+			if (idx != last) {
+				components[idx] = std::move(components[last]);
+			}
+			components.pop_back();
 
-			assert(idx <= last);
+			if (shrink_policy == ShrinkPolicy::ReleaseEmptyPages && components.size() % PageSize == 0) {
+				components.ShrinkKeeping(1);
+			}
+		}
 
-			if (idx != last)
+		void SwapComponents(ComponentIndex idx1, ComponentIndex idx2) override
+		{
+			using std::swap;
+			swap(components[idx1], components[idx2]);
+		}
+
+		void ReserveComponents(size_t capacity) override { components.reserve(capacity); }
+		// freed pages are returned to the system, along with the ones cached by other stores of the type
+		void ShrinkComponents() override
+		{
+			components.shrink_to_fit();
+			PagedVector<Comp>::Allocator::ReleaseUnused();
+		}
+
+		ComponentsMemory GetComponentsMemory() const noexcept override
+		{
+			const auto cached = PagedVector<Comp>::Allocator::FreePagesCount() * PageSize * sizeof(Comp);
+			return { components.capacity(), components.size() * sizeof(Comp), components.capacity() * sizeof(Comp), cached };
+		}
+
+		void WriteComponents(BinaryWriter& out) const override
+		{
+			if constexpr (HasSerializer<Comp>)
 			{
-				components[idx] = std::move(components[last]);
-				components.pop_back();
+				for (const auto& comp : components) {
+					out.Write(comp);
+				}
+			}
+			else if constexpr (std::is_trivially_copyable_v<Comp>)
+			{
+				for (size_t idx = 0; idx < components.size(); idx += components.RunLength(idx)) {
+					out.WriteBytes(components.RunAt(idx), components.RunLength(idx) * sizeof(Comp));
+				}
+			}
+			else
+			{
+				assert(false && "Component is not serializable");
+			}
+		}
 
-				entities[idx] = std::move(entities[last]);
-				entities.pop_back();
+		// components with serializers are assumed to be of the same size as the first one
+		size_t EstimateComponentsSize() const override
+		{
+			if constexpr (HasSerializer<Comp>)
+			{
+				if (components.empty()) return 0;
+
+				BinaryWriter probe;
+				probe.Write(components[0]);
+				return probe.Size() * components.size();
+			}
+			else
+			{
+				return components.size() * sizeof(Comp);
+			}
+		}
+
+		bool ReadComponents(BinaryReader& in, size_t count) override
+		{
+			if constexpr (HasSerializer<Comp>)
+			{
+				components.reserve(count);
+				for (size_t i = 0; i < count && !in.Failed(); ++i) {
+					in.Read(components.emplace_back());
+				}
+				return !in.Failed() && components.size() == count;
+			}
+			else if constexpr (std::is_trivially_copyable_v<Comp>)
+			{
+				const auto* block = (count <= in.Remaining() / sizeof(Comp)) ? in.Skip(count * sizeof(Comp)) : nullptr;
+				if (!block) return false;
 
-				return entities[idx];
+				components.AppendBytes(block, count);
+				return true;
 			}
 			else
 			{
-				components.pop_back();
-				entities.pop_back();
-				return Entity{};
+				return false;
 			}
 		}
 
 	public:
-		std::vector<Comp> components;
-		std::vector<Entity> entities;
+		// paged, so that adding components never moves existing ones
+		PagedVector<Comp> components;
+	};
+
+	/*
+	* Store of tag components, which have no data: only the set of entities and their change ticks are kept,
+	* all entities share the same empty instance.
+	*/
+	template<class Comp> requires std::is_empty_v<Comp>
+	class ComponentStore<Comp> : public ComponentStoreBase
+	{
+	public:
+		template<class... Args>
+		Comp* Create(Entity entity, ChangeTick tick, Args&&...)
+		{
+			InsertTag(entity, tick);
+			NotifyObservers(ObserverEvent::Add, { &entity, 1 });
+			return &instance;
+		}
+
+		void CreateMany(std::span<const Entity> batch, ChangeTick tick, const Comp&)
+		{
+			for (const auto entity : batch) {
+				InsertTag(entity, tick);
+			}
+			NotifyObservers(ObserverEvent::Add, batch);
+		}
+
+		void CreateMany(std::span<const Entity> batch, ChangeTick tick, std::span<Comp>)
+		{
+			CreateMany(batch, tick, instance);
+		}
+
+		Comp* Get(ComponentIndex) { return &instance; }
+		const Comp* Get(ComponentIndex) const { return &instance; }
+
+		Comp* Find(Entity entity) { return Contains(entity) ? &instance : nullptr; }
+		const Comp* Find(Entity entity) const { return Contains(entity) ? &instance : nullptr; }
+
+		static constexpr size_t PageSize = std::numeric_limits<size_t>::max();
+
+		bool IsSerializable() const noexcept override { return SnapshotComponent<Comp>; }
+
+		// Indexable as an array of components, so that tags can be iterated like other components
+		struct Array
+		{
+			Comp& operator[](size_t) const noexcept { return instance; }
+		};
+
+	protected:
+		void EraseComponent(Entity, ComponentIndex) override {}
+
+		void SwapComponents(ComponentIndex, ComponentIndex) override {}
+		void ReserveComponents(size_t) override {}
+		void ShrinkComponents() override {}
+
+		// only the set of entities is saved
+		void WriteComponents(BinaryWriter&) const override {}
+		size_t EstimateComponentsSize() const override { return 0; }
+
+		// tags take no memory, so capacity is the one of the entity list
+		ComponentsMemory GetComponentsMemory() const noexcept override { return { entities.capacity(), 0, 0 }; }
+
+		bool ReadComponents(BinaryReader&, size_t) override { return true; }
+
+	private:
+		static inline Comp instance{};
+
+		void InsertTag(Entity entity, ChangeTick tick)
+		{
+			assert(!Contains(entity));
+
+			Insert(entity);
+			InsertTicks(tick);
+
+			NotifyAdd(entity);
+		}
 	};
 }
\ No newline at end of file
@@ -1,52 +1,90 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 #include <limits>
+#include <concepts>
 #include <cassert>
 
 namespace Expanse::ecs
 {
-	class Entity final
+	/*
+	* Entity handle, packing slot index and slot version into single integer of BaseType.
+	* Upper VersionBits bits store version, the rest stores index.
+	* All bits set is reserved as a null value, so MaxIndex is never used by a live entity.
+	*/
+	template<std::unsigned_integral T, size_t VersionBitsCount>
+	class TEntity final
 	{
 	public:
 		// Basic settings
-		using BaseType = uint16_t;
-		static constexpr size_t VersionBits = 2;
+		using BaseType = T;
+		static constexpr size_t VersionBits = VersionBitsCount;
+
+		static_assert(VersionBits > 0 && VersionBits < sizeof(BaseType) * 8, "Entity must have both index and version bits");
 
 		// Derived constants
 		static constexpr BaseType NullValue = std::numeric_limits<BaseType>::max();
 		static constexpr size_t IndexBits = sizeof(BaseType) * 8 - VersionBits;
 		static constexpr BaseType IndexMask = NullValue >> VersionBits;
-		static constexpr BaseType MaxVersion = (1 << VersionBits) - 1;
-		static constexpr BaseType MaxIndex = (1 << IndexBits) - 1;
+		static constexpr BaseType MaxVersion = NullValue >> IndexBits;
+		static constexpr BaseType MaxIndex = IndexMask;
 
 	public:
 
-		constexpr Entity() = default;
-		constexpr explicit Entity(BaseType index) : value(index) {
-			assert(index <= MaxIndex);
+		constexpr TEntity() = default;
+
+		template<std::integral I>
+		constexpr explicit TEntity(I index) : value(static_cast<BaseType>(index)) {
+			assert(static_cast<uint64_t>(index) <= static_cast<uint64_t>(MaxIndex));
 		}
-		constexpr explicit Entity(size_t index) : value(static_cast<BaseType>(index)) {
-			assert( index <= static_cast<size_t>(MaxIndex));
+
+		template<std::integral I, std::integral V>
+		constexpr TEntity(I index, V version)
+			: value(static_cast<BaseType>(index) | (static_cast<BaseType>(version & MaxVersion) << IndexBits))
+		{
+			assert(static_cast<uint64_t>(index) <= static_cast<uint64_t>(MaxIndex));
 		}
 
 		operator bool () const noexcept { return value != NullValue; }
 
-		bool operator==(const Entity& ent) const noexcept { return value == ent.value; }
-		bool operator!=(const Entity& ent) const noexcept { return value != ent.value; }
+		bool operator==(const TEntity& ent) const noexcept { return value == ent.value; }
+		bool operator!=(const TEntity& ent) const noexcept { return value != ent.value; }
 
 		[[nodiscard]] BaseType Index() const noexcept { return value & IndexMask; }
 		[[nodiscard]] BaseType Version() const noexcept { return value >> IndexBits; }
 
+		// Raw packed value, for hashing and serialization
+		[[nodiscard]] BaseType Value() const noexcept { return value; }
+
 		void IncVersion() {
-			value = Index() | ((Version() + 1) << IndexBits);
+			value = Index() | (static_cast<BaseType>((Version() + 1) & MaxVersion) << IndexBits);
 		}
 
 	private:
 		BaseType value = NullValue;
 	};
 
+	/*
+	* Entity layout used by the ECS.
+	* 32-bit handles by default, define EXPANSE_ECS_ENTITY_64BIT to switch to 64-bit ones.
+	* EXPANSE_ECS_ENTITY_VERSION_BITS overrides number of version bits for the selected layout.
+	*/
+#ifdef EXPANSE_ECS_ENTITY_64BIT
+	using EntityBaseType = uint64_t;
+	#ifndef EXPANSE_ECS_ENTITY_VERSION_BITS
+	#define EXPANSE_ECS_ENTITY_VERSION_BITS 24
+	#endif
+#else
+	using EntityBaseType = uint32_t;
+	#ifndef EXPANSE_ECS_ENTITY_VERSION_BITS
+	#define EXPANSE_ECS_ENTITY_VERSION_BITS 10
+	#endif
+#endif
+
+	using Entity = TEntity<EntityBaseType, EXPANSE_ECS_ENTITY_VERSION_BITS>;
+
 	// Type that is used to store component indices in component pools
 	using ComponentIndex = Entity::BaseType;
 	inline constexpr auto NullComponentIndex = std::numeric_limits<ComponentIndex>::max();
-}
\ No newline at end of file
+}
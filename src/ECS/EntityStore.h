@@ -1,43 +1,18 @@
 #pragma once
 
-#include <vector>
-
 #include "Entity.h"
 
 namespace Expanse::ecs
 {
+	/*
+	* Entity slot in the World's entity table.
+	* Components are not referenced from here, each ComponentStore keeps its own entity -> component mapping.
+	*/
 	struct EntityStore
 	{
 		EntityStore(size_t index) : entity(index) {}
 
-		// make sure this struct is never copied, only moved
-		EntityStore(const EntityStore&) = delete;
-		EntityStore(EntityStore&&) = default;
-		EntityStore& operator=(const EntityStore&) = delete;
-		EntityStore& operator=(EntityStore&&) = default;
-
-		void SetComponent(size_t comp_type, ComponentIndex comp_index)
-		{
-			components.resize(std::max(components.size(), comp_type + 1), NullComponentIndex);
-			components[comp_type] = comp_index;
-		}
-
-		void ResetComponent(size_t comp_type)
-		{
-			components[comp_type] = NullComponentIndex;
-		}
-
-		ComponentIndex GetComponentIndex(size_t comp_type) const noexcept
-		{
-			return (comp_type < components.size()) ? components[comp_type] : NullComponentIndex;
-		}
-
-		bool HasComponent(size_t comp_type) const noexcept
-		{
-			return (comp_type < components.size()) && components[comp_type] != NullComponentIndex;
-		}
-
+		// Live entity handle, or for a free slot: index of the next free slot and version to reuse
 		Entity entity;
-		std::vector<ComponentIndex> components;
 	};
-}
\ No newline at end of file
+}
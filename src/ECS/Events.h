@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+namespace Expanse::ecs
+{
+	struct EventsBase
+	{
+		virtual ~EventsBase() = default;
+
+		virtual void Update() = 0;
+	};
+
+	/*
+	* Channel of events of type T, replacing short-lived "event" components.
+	*
+	* Events are appended to the current frame buffer, Update swaps buffers and clears the older one,
+	* so events live for two frames: systems running before the sender see them on the next frame.
+	* Every reader keeps its own cursor, so any number of systems can read the same events.
+	* Readers, which skip more than one Update, miss older events.
+	*/
+	template<typename T>
+	class Events final : public EventsBase
+	{
+	public:
+		// Cursor of a single reader, events it has already seen are skipped
+		class Reader
+		{
+			friend class Events;
+			size_t next_id = 0;
+		};
+
+		void Send(T event)
+		{
+			current.push_back(std::move(event));
+		}
+
+		template<typename... Args>
+		void Emplace(Args&&... args)
+		{
+			current.push_back(T{ std::forward<Args>(args)... });
+		}
+
+		// Calls func(const T&) for each event, that reader hasn't seen yet, oldest first
+		template<typename Func>
+		void Read(Reader& reader, Func func) const
+		{
+			const auto start = std::max(reader.next_id, previous_start);
+
+			for (size_t i = start - previous_start; i < previous.size(); ++i) {
+				func(previous[i]);
+			}
+
+			for (size_t i = std::max(start, current_start) - current_start; i < current.size(); ++i) {
+				func(current[i]);
+			}
+
+			reader.next_id = current_start + current.size();
+		}
+
+		// True if there are events, that reader hasn't seen yet
+		bool HasUnread(const Reader& reader) const noexcept
+		{
+			return std::max(reader.next_id, previous_start) < current_start + current.size();
+		}
+
+		// Starts new frame, events sent two frames ago are dropped
+		void Update() override
+		{
+			std::swap(previous, current);
+			current.clear();
+
+			previous_start = current_start;
+			current_start += previous.size();
+		}
+
+	private:
+		// buffers are swapped, so their memory is reused
+		std::vector<T> previous;
+		std::vector<T> current;
+
+		// ids of the first events in buffers, ids are never reused
+		size_t previous_start = 0;
+		size_t current_start = 0;
+	};
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "ComponentStore.h"
+
+#include <tuple>
+#include <type_traits>
+#include <algorithm>
+#include <utility>
+
+namespace Expanse::ecs
+{
+	/*
+	* Persistent set of entities having all of the Comps, kept up to date by component stores.
+	*
+	* If none of the stores is owned by another group, the group owns them: matching entities
+	* are kept in the prefix of every store in the same order, so iteration is a plain loop
+	* over component arrays. Otherwise group keeps its own set of matching entities.
+	*
+	* Adding or removing any of the Comps from inside ForEach is not allowed.
+	*/
+	template<typename... Comps>
+	class GroupStorage final : public StoreListener
+	{
+		static_assert(sizeof...(Comps) > 0, "Group must include at least one component type");
+		static_assert((... && !std::is_const_v<Comps>), "Group storage is keyed by non-const component types");
+
+	public:
+		explicit GroupStorage(ComponentStore<Comps>*... stores_)
+			: stores(stores_...)
+		{
+			owning = (... && (stores_->owner == nullptr));
+			if (owning) {
+				((stores_->owner = this), ...);
+			}
+			(stores_->AddListener(this), ...);
+
+			// pick up entities, which were already there
+			const ComponentStoreBase* smallest = std::get<0>(stores);
+			((smallest = (stores_->Size() < smallest->Size()) ? stores_ : smallest), ...);
+
+			const auto entities = smallest->entities;
+			for (const auto entity : entities) {
+				OnAdd(entity);
+			}
+		}
+
+		~GroupStorage()
+		{
+			std::apply([this](auto*... store) {
+				((store->RemoveListener(this)), ...);
+				if (owning) {
+					((store->owner = nullptr, store->owned_size = 0), ...);
+				}
+			}, stores);
+		}
+
+		GroupStorage(const GroupStorage&) = delete;
+		GroupStorage& operator=(const GroupStorage&) = delete;
+
+		// True if group keeps its entities packed in the prefix of component stores
+		bool IsOwning() const noexcept { return owning; }
+
+		size_t Size() const noexcept { return owning ? OwnedSize() : members.Size(); }
+
+		// Changes whenever an entity enters or leaves the group
+		uint64_t Generation() const noexcept { return generation; }
+
+		bool Contains(Entity entity) const noexcept
+		{
+			if (owning)
+			{
+				const auto* store = std::get<0>(stores);
+				return store->Contains(entity) && (store->IndexOf(entity) < store->owned_size);
+			}
+			return members.Contains(entity);
+		}
+
+		// Calls func(entity, args&...) for each entity in group, Args are Comps with optional const qualifiers.
+		// Components accessed for writing are marked as changed at tick.
+		template<typename... Args, typename Func>
+		void ForEach(Func& func, ChangeTick tick)
+		{
+			static_assert(sizeof...(Args) == sizeof...(Comps));
+
+			ForEachImpl<Args...>(func, tick, std::index_sequence_for<Comps...>{});
+		}
+
+		void OnAdd(Entity entity) override
+		{
+			const bool has_all = std::apply([entity](auto*... store) { return (... && store->Contains(entity)); }, stores);
+			if (!has_all || Contains(entity)) return;
+
+			if (owning)
+			{
+				const auto pos = static_cast<ComponentIndex>(OwnedSize());
+				std::apply([entity, pos](auto*... store) { ((store->Swap(store->IndexOf(entity), pos), ++store->owned_size), ...); }, stores);
+			}
+			else
+			{
+				members.Insert(entity);
+			}
+			++generation;
+		}
+
+		void OnRemove(Entity entity) override
+		{
+			if (!Contains(entity)) return;
+
+			if (owning)
+			{
+				const auto pos = static_cast<ComponentIndex>(OwnedSize() - 1);
+				std::apply([entity, pos](auto*... store) { ((store->Swap(store->IndexOf(entity), pos), --store->owned_size), ...); }, stores);
+			}
+			else
+			{
+				members.Erase(entity);
+			}
+			++generation;
+		}
+
+		/*
+		* Sorts entities of the group in place with compare(const Comp&, const Comp&), Comp is one of the Comps.
+		* ForEach visits them in sorted order until group is changed. Change ticks are not updated.
+		*/
+		template<typename Comp, typename Compare>
+		void Sort(Compare compare, SortMode mode)
+		{
+			auto* key_store = std::get<ComponentStore<Comp>*>(stores);
+
+			if (owning)
+			{
+				details::SortPositions(0, OwnedSize(), mode,
+					[key_store, &compare](ComponentIndex idx1, ComponentIndex idx2) { return compare(std::as_const(*key_store->Get(idx1)), std::as_const(*key_store->Get(idx2))); },
+					[this](ComponentIndex idx1, ComponentIndex idx2) { std::apply([idx1, idx2](auto*... store) { (store->Swap(idx1, idx2), ...); }, stores); });
+			}
+			else
+			{
+				const auto& entities = members.entities;
+				details::SortPositions(0, members.Size(), mode,
+					[key_store, &entities, &compare](ComponentIndex idx1, ComponentIndex idx2) { return compare(std::as_const(*key_store->Find(entities[idx1])), std::as_const(*key_store->Find(entities[idx2]))); },
+					[this](ComponentIndex idx1, ComponentIndex idx2) { members.SwapAt(idx1, idx2); });
+			}
+		}
+
+	private:
+		std::tuple<ComponentStore<Comps>*...> stores;
+		bool owning = false;
+
+		// matching entities, if stores are not owned
+		EntitySet members;
+
+		uint64_t generation = 0;
+
+		// number of entities in owned prefix, same in all stores
+		size_t OwnedSize() const noexcept { return std::get<0>(stores)->owned_size; }
+
+		template<typename... Args, typename Func, size_t... I>
+		void ForEachImpl(Func& func, ChangeTick tick, std::index_sequence<I...>)
+		{
+			if (owning)
+			{
+				const auto size = OwnedSize();
+				((std::is_const_v<Args> ? void() : MarkPrefixChanged(std::get<I>(stores), size, tick)), ...);
+
+				const Entity* entities = std::get<0>(stores)->entities.data();
+
+				// pages are power of two sized, so every store is contiguous within the smallest page
+				constexpr size_t RunSize = std::min({ ComponentStore<Comps>::PageSize... });
+
+				for (size_t begin = 0; begin < size; begin += RunSize)
+				{
+					const auto count = std::min(RunSize, size - begin);
+					const auto arrays = std::make_tuple(ComponentArray<Args>(std::get<I>(stores), begin)...);
+
+					for (size_t i = 0; i < count; ++i) {
+						func(entities[begin + i], std::get<I>(arrays)[i]...);
+					}
+				}
+			}
+			else
+			{
+				((std::is_const_v<Args> ? void() : std::get<I>(stores)->MarkStoreChanged(tick)), ...);
+
+				for (const auto entity : members.entities)
+				{
+					const auto indices = std::make_tuple(std::get<I>(stores)->IndexOf(entity)...);
+					((std::is_const_v<Args> ? void() : std::get<I>(stores)->MarkChangedAt(std::get<I>(indices), tick)), ...);
+
+					func(entity, static_cast<Args&>(*std::get<I>(stores)->Get(std::get<I>(indices)))...);
+				}
+			}
+		}
+
+		template<typename Arg, typename Store>
+		static auto ComponentArray(Store* store, size_t begin) noexcept
+		{
+			if constexpr (std::is_empty_v<Arg>) {
+				return typename Store::Array{};
+			} else {
+				return static_cast<Arg*>(store->components.RunAt(begin));
+			}
+		}
+
+		static void MarkPrefixChanged(ComponentStoreBase* store, size_t size, ChangeTick tick)
+		{
+			for (size_t i = 0; i < size; ++i) {
+				store->MarkChangedAt(static_cast<ComponentIndex>(i), tick);
+			}
+			store->MarkStoreChanged(tick);
+		}
+	};
+
+	/*
+	* Lightweight handle to the group storage, returned by World::Group.
+	* Const-qualified component types are passed to callbacks by const reference,
+	* others are marked as changed at the tick handle was created with.
+	*/
+	template<typename... Args>
+	class Group
+	{
+	public:
+		using Storage = GroupStorage<std::remove_const_t<Args>...>;
+
+		Group(Storage& storage_, ChangeTick tick_)
+			: storage(&storage_)
+			, tick(tick_)
+		{}
+
+		bool IsOwning() const noexcept { return storage->IsOwning(); }
+
+		size_t Size() const noexcept { return storage->Size(); }
+
+		// Changes whenever an entity enters or leaves the group, e.g. to sort it only when needed
+		uint64_t Generation() const noexcept { return storage->Generation(); }
+
+		bool Contains(Entity entity) const noexcept { return storage->Contains(entity); }
+
+		// Sorts group in place by component Comp, see GroupStorage::Sort
+		//
+		//	group.Sort<TerrainChunk>([](const auto& ch1, const auto& ch2) { ... }, SortMode::Incremental);
+		template<typename Comp, typename Compare>
+		void Sort(Compare compare, SortMode mode = SortMode::Full) const
+		{
+			storage->template Sort<std::remove_const_t<Comp>>(compare, mode);
+		}
+
+		// Calls func(entity, args&...) for each entity in group
+		template<typename Func>
+		void ForEach(Func func) const
+		{
+			storage->template ForEach<Args...>(func, tick);
+		}
+
+	private:
+		Storage* storage;
+		ChangeTick tick;
+	};
+}
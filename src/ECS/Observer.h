@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ComponentStore.h"
+
+#include <span>
+
+namespace Expanse::ecs
+{
+	/*
+	* Batch of entities passed to observers of Comp, see World::OnAdd and World::OnRemove.
+	* Components are alive while observer runs: already added or not removed yet.
+	*/
+	template<typename Comp>
+	class ObservedBatch
+	{
+	public:
+		ObservedBatch(std::span<const Entity> entities_, const ComponentStore<Comp>& store_)
+			: entities(entities_)
+			, store(store_)
+		{}
+
+		std::span<const Entity> Entities() const noexcept { return entities; }
+		size_t Size() const noexcept { return entities.size(); }
+
+		const Comp& Get(size_t i) const { return *store.Get(store.IndexOf(entities[i])); }
+
+		// Calls func(entity, const Comp&) for each entity of the batch
+		template<typename Func>
+		void ForEach(Func func) const
+		{
+			for (const auto entity : entities) {
+				func(entity, *store.Get(store.IndexOf(entity)));
+			}
+		}
+
+	private:
+		std::span<const Entity> entities;
+		const ComponentStore<Comp>& store;
+	};
+}
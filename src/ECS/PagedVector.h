@@ -0,0 +1,278 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <new>
+#include <bit>
+#include <memory>
+#include <cassert>
+#include <iterator>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <cstring>
+#include <cstddef>
+
+namespace Expanse::ecs
+{
+	/*
+	* Allocator of fixed-size pages for PagedVector<T>, shared by all vectors of the same type.
+	* Freed pages are kept for reuse until ReleaseUnused is called.
+	*/
+	template<typename T, size_t PageBytes>
+	class PageAllocator
+	{
+	public:
+		static void* Allocate()
+		{
+			auto& pool = GetPool();
+			{
+				std::scoped_lock lock(pool.mutex);
+				if (!pool.free_pages.empty())
+				{
+					void* page = pool.free_pages.back();
+					pool.free_pages.pop_back();
+					return page;
+				}
+			}
+			return ::operator new(PageBytes, std::align_val_t{ alignof(T) });
+		}
+
+		static void Free(void* page)
+		{
+			auto& pool = GetPool();
+			std::scoped_lock lock(pool.mutex);
+			pool.free_pages.push_back(page);
+		}
+
+		// Returns cached free pages to the system
+		static void ReleaseUnused()
+		{
+			auto& pool = GetPool();
+			std::scoped_lock lock(pool.mutex);
+			for (void* page : pool.free_pages) {
+				::operator delete(page, std::align_val_t{ alignof(T) });
+			}
+			pool.free_pages.clear();
+		}
+
+		static size_t FreePagesCount()
+		{
+			auto& pool = GetPool();
+			std::scoped_lock lock(pool.mutex);
+			return pool.free_pages.size();
+		}
+
+	private:
+		struct Pool
+		{
+			std::mutex mutex;
+			std::vector<void*> free_pages;
+		};
+
+		// never destroyed, so that vectors in static storage can free their pages at exit
+		static Pool& GetPool()
+		{
+			static Pool& pool = *new Pool;
+			return pool;
+		}
+	};
+
+	/*
+	* Vector, which keeps its elements in fixed-size pages. Growth allocates a new page and never
+	* moves existing elements, so pointers to them stay valid until they are erased.
+	* Page size is a power of two, so element lookup is a shift and a mask.
+	*/
+	template<typename T>
+	class PagedVector
+	{
+	public:
+		static constexpr size_t PageBytes = 16 * 1024;
+		static constexpr size_t PageSize = std::bit_floor(std::max<size_t>(1, PageBytes / sizeof(T)));
+
+		using Allocator = PageAllocator<T, PageSize * sizeof(T)>;
+
+		template<bool Const>
+		class Iterator
+		{
+		public:
+			using Container = std::conditional_t<Const, const PagedVector, PagedVector>;
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type = T;
+			using difference_type = std::ptrdiff_t;
+			using pointer = std::conditional_t<Const, const T*, T*>;
+			using reference = std::conditional_t<Const, const T&, T&>;
+
+			Iterator() = default;
+			Iterator(Container* vec_, size_t idx_) : vec(vec_), idx(idx_) {}
+
+			reference operator*() const { return (*vec)[idx]; }
+			pointer operator->() const { return &(*vec)[idx]; }
+			reference operator[](difference_type n) const { return (*vec)[idx + n]; }
+
+			Iterator& operator++() { ++idx; return *this; }
+			Iterator operator++(int) { auto tmp = *this; ++idx; return tmp; }
+			Iterator& operator--() { --idx; return *this; }
+			Iterator operator--(int) { auto tmp = *this; --idx; return tmp; }
+
+			Iterator& operator+=(difference_type n) { idx += n; return *this; }
+			Iterator& operator-=(difference_type n) { idx -= n; return *this; }
+			friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+			friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+			friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+			friend difference_type operator-(const Iterator& a, const Iterator& b) { return static_cast<difference_type>(a.idx) - static_cast<difference_type>(b.idx); }
+
+			bool operator==(const Iterator& other) const { return idx == other.idx; }
+			auto operator<=>(const Iterator& other) const { return idx <=> other.idx; }
+
+		private:
+			Container* vec = nullptr;
+			size_t idx = 0;
+		};
+
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+
+		PagedVector() = default;
+
+		PagedVector(PagedVector&& other) noexcept
+			: pages(std::move(other.pages))
+			, count(std::exchange(other.count, 0))
+		{}
+
+		PagedVector& operator=(PagedVector&& other) noexcept
+		{
+			if (this != &other)
+			{
+				clear();
+				ReleasePages(0);
+				pages = std::move(other.pages);
+				count = std::exchange(other.count, 0);
+			}
+			return *this;
+		}
+
+		PagedVector(const PagedVector&) = delete;
+		PagedVector& operator=(const PagedVector&) = delete;
+
+		~PagedVector()
+		{
+			clear();
+			ReleasePages(0);
+		}
+
+		size_t size() const noexcept { return count; }
+		bool empty() const noexcept { return count == 0; }
+		size_t capacity() const noexcept { return pages.size() * PageSize; }
+
+		T& operator[](size_t idx) noexcept { return pages[idx / PageSize][idx % PageSize]; }
+		const T& operator[](size_t idx) const noexcept { return pages[idx / PageSize][idx % PageSize]; }
+
+		T& back() noexcept { return (*this)[count - 1]; }
+		const T& back() const noexcept { return (*this)[count - 1]; }
+
+		// Pointer to contiguous run of elements, that starts at idx and ends at the page boundary
+		T* RunAt(size_t idx) noexcept { return &(*this)[idx]; }
+		const T* RunAt(size_t idx) const noexcept { return &(*this)[idx]; }
+
+		iterator begin() noexcept { return { this, 0 }; }
+		iterator end() noexcept { return { this, count }; }
+		const_iterator begin() const noexcept { return { this, 0 }; }
+		const_iterator end() const noexcept { return { this, count }; }
+
+		template<typename... Args>
+		T& emplace_back(Args&&... args)
+		{
+			EnsureCapacity(count + 1);
+
+			// construct_at, like std::vector, uses parenthesized aggregate init, so missing members are value-initialized
+			T* ptr = &pages[count / PageSize][count % PageSize];
+			if constexpr (std::is_constructible_v<T, Args...>) {
+				std::construct_at(ptr, std::forward<Args>(args)...);
+			} else {
+				new (ptr) T{ std::forward<Args>(args)... };
+			}
+			++count;
+			return *ptr;
+		}
+
+		void push_back(const T& value) { emplace_back(value); }
+		void push_back(T&& value) { emplace_back(std::move(value)); }
+
+		// Appends src_count elements copied from raw memory, which doesn't have to be aligned
+		void AppendBytes(const void* src, size_t src_count)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+
+			EnsureCapacity(count + src_count);
+
+			const auto* bytes = static_cast<const std::byte*>(src);
+			while (src_count > 0)
+			{
+				const auto run = std::min(src_count, PageSize - count % PageSize);
+				std::memcpy(RunAt(count), bytes, run * sizeof(T));
+				bytes += run * sizeof(T);
+				src_count -= run;
+				count += run;
+			}
+		}
+
+		// Number of elements in contiguous run, that starts at idx
+		size_t RunLength(size_t idx) const noexcept
+		{
+			return std::min(count - idx, PageSize - idx % PageSize);
+		}
+
+		void pop_back() noexcept
+		{
+			assert(count > 0);
+			--count;
+			std::destroy_at(&(*this)[count]);
+		}
+
+		void clear() noexcept
+		{
+			while (count > 0) {
+				pop_back();
+			}
+		}
+
+		// Allocates pages for at least capacity elements
+		void reserve(size_t new_capacity)
+		{
+			EnsureCapacity(new_capacity);
+		}
+
+		// Returns pages, that hold no elements, to the allocator
+		void shrink_to_fit()
+		{
+			ReleasePages((count + PageSize - 1) / PageSize);
+		}
+
+		// Keeps at most spare_pages empty pages after the last element
+		void ShrinkKeeping(size_t spare_pages)
+		{
+			ReleasePages((count + PageSize - 1) / PageSize + spare_pages);
+		}
+
+	private:
+		std::vector<T*> pages;
+		size_t count = 0;
+
+		void EnsureCapacity(size_t new_capacity)
+		{
+			while (capacity() < new_capacity) {
+				pages.push_back(static_cast<T*>(Allocator::Allocate()));
+			}
+		}
+
+		void ReleasePages(size_t keep_pages)
+		{
+			while (pages.size() > keep_pages)
+			{
+				Allocator::Free(pages.back());
+				pages.pop_back();
+			}
+		}
+	};
+}
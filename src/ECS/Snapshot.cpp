@@ -0,0 +1,150 @@
+#include "Snapshot.h"
+
+#include "Utils/MappedFile.h"
+
+#include <fstream>
+
+namespace Expanse::ecs
+{
+	namespace
+	{
+		// Live slots hold their own index, free ones form a single list, which goes through all of them
+		bool IsValidEntityTable(const std::vector<EntityStore>& entities, Entity::BaseType head, Entity::BaseType null_index)
+		{
+			size_t free_count = 0;
+			for (size_t idx = 0; idx < entities.size(); ++idx)
+			{
+				if (entities[idx].entity.Index() != idx) {
+					++free_count;
+				}
+			}
+
+			// counting visited slots also stops cycles
+			size_t visited = 0;
+			for (auto idx = head; idx != null_index; idx = entities[idx].entity.Index())
+			{
+				if (idx >= entities.size() || entities[idx].entity.Index() == idx || ++visited > free_count)
+					return false;
+			}
+			return visited == free_count;
+		}
+	}
+
+	void World::WriteSnapshot(BinaryWriter& out) const
+	{
+		assert(parallel_sections == 0);
+
+		static_assert(std::is_trivially_copyable_v<EntityStore>);
+
+		// one allocation instead of repeated growth, which costs more than writing itself
+		size_t expected_size = 64 + entities.size() * sizeof(EntityStore);
+		for (const auto& store : comp_stores)
+		{
+			if (store && store->IsSerializable()) {
+				expected_size += 16 + store->EstimateWriteSize();
+			}
+		}
+		out.Reserve(out.Size() + expected_size);
+
+		out.Write(Snapshot::Magic);
+		out.Write(Snapshot::Version);
+		out.Write(static_cast<uint32_t>(sizeof(Entity)));
+
+		out.Write<uint64_t>(entities.size());
+		out.Write(free_head);
+		out.WriteBytes(entities.data(), entities.size() * sizeof(EntityStore));
+
+		const auto stores_count_offset = out.Size();
+		out.Write<uint32_t>(0);
+
+		uint32_t stores_count = 0;
+		for (size_t type_index = 0; type_index < comp_stores.size(); ++type_index)
+		{
+			const auto& store = comp_stores[type_index];
+			if (!store || store->Size() == 0 || !store->IsSerializable()) continue;
+
+			out.Write(TypeRegistry<_ComponentsTypeFamily>::IdOf(type_index));
+
+			// size is patched afterwards, so that readers can skip unknown blocks
+			const auto size_offset = out.Size();
+			out.Write<uint64_t>(0);
+			store->Write(out);
+			out.WriteAt<uint64_t>(size_offset, out.Size() - size_offset - sizeof(uint64_t));
+
+			++stores_count;
+		}
+		out.WriteAt(stores_count_offset, stores_count);
+	}
+
+	bool World::ReadSnapshot(BinaryReader& in)
+	{
+		assert(parallel_sections == 0);
+		assert(entities.empty() && "Snapshot can only be restored into empty world");
+
+		if (in.Read<uint32_t>() != Snapshot::Magic) return false;
+		if (in.Read<uint32_t>() != Snapshot::Version) return false;
+		if (in.Read<uint32_t>() != sizeof(Entity)) return false;
+
+		const auto slots_count = in.Read<uint64_t>();
+		const auto head = in.Read<Entity::BaseType>();
+		if (slots_count > in.Remaining() / sizeof(EntityStore)) return false;
+
+		entities.assign(static_cast<size_t>(slots_count), EntityStore{ 0 });
+		in.ReadBytes(entities.data(), entities.size() * sizeof(EntityStore));
+		if (in.Failed() || !IsValidEntityTable(entities, head, NullIndex))
+		{
+			entities.clear();
+			return false;
+		}
+		free_head = head;
+
+		const auto stores_count = in.Read<uint32_t>();
+		const auto tick = CurrentTick();
+
+		for (uint32_t i = 0; i < stores_count && !in.Failed(); ++i)
+		{
+			const auto type_id = in.Read<TypeId>();
+			const auto block_size = in.Read<uint64_t>();
+			if (block_size > in.Remaining()) return false;
+
+			BinaryReader block{ { in.Skip(static_cast<size_t>(block_size)), static_cast<size_t>(block_size) } };
+
+			const auto factory = FindStoreFactory(type_id);
+			const auto type_index = ComponentTypeIndexOf(type_id);
+			if (!factory || type_index == TypeRegistry<_ComponentsTypeFamily>::NullIndex) continue;
+
+			comp_stores.resize(std::max(comp_stores.size(), type_index + 1));
+
+			auto& store = comp_stores[type_index];
+			if (!store) {
+				store = factory();
+			}
+
+			if (store->Size() > 0 || !store->Read(block, tick, entities)) return false;
+		}
+
+		return !in.Failed();
+	}
+
+	/*************************************************************************************************/
+
+	bool SaveSnapshot(const World& world, const std::string& path)
+	{
+		BinaryWriter out;
+		world.WriteSnapshot(out);
+
+		std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+		const auto data = out.Data();
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		return file.good();
+	}
+
+	bool LoadSnapshot(World& world, const std::string& path)
+	{
+		const MappedFile file{ path };
+		if (!file.IsOpen()) return false;
+
+		BinaryReader in{ file.Data() };
+		return world.ReadSnapshot(in);
+	}
+}
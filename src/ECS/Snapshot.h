@@ -0,0 +1,37 @@
+#pragma once
+
+#include "World.h"
+
+#include <string>
+
+namespace Expanse::ecs
+{
+	/*
+	* Binary snapshot of World, all values are in native byte order:
+	*
+	*	header:		magic, format version, sizeof(Entity)
+	*	entities:	number of slots, head of the free list, raw entity table
+	*	stores:		number of stores, then for each store:
+	*				component TypeId, size of the block in bytes,
+	*				number of components, raw array of entities, components
+	*
+	* Only components, which opted in with SnapshotComponent, are saved.
+	* Trivially copyable components are written page by page and read back with memcpy,
+	* other ones go through their Serializer. Blocks of component types unknown to
+	* the reading program are skipped.
+	*
+	* Entity table is validated on load: free list must stay in range and go through all free slots,
+	* stored components must belong to live entities of the same version.
+	*/
+	namespace Snapshot
+	{
+		constexpr uint32_t Magic = 0x4e535845;	// "EXSN"
+		constexpr uint32_t Version = 1;
+	}
+
+	// Returns false if file couldn't be written
+	bool SaveSnapshot(const World& world, const std::string& path);
+
+	// Maps snapshot file into memory and restores world from it, world must have no entities
+	bool LoadSnapshot(World& world, const std::string& path);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+namespace Expanse::ecs
+{
+	/*
+	* Components are only saved to snapshots, if they opt in, because ids of GPU resources,
+	* handles and pointers mean nothing after restore. Component must be BinarySerializable:
+	*
+	*	template<>
+	*	inline constexpr bool ecs::SnapshotComponent<Game::Terrain::TerrainChunk> = true;
+	*
+	* Specialization has to be declared before the component is used with World.
+	*/
+	template<class Comp>
+	inline constexpr bool SnapshotComponent = false;
+}
@@ -0,0 +1,82 @@
+#include "World.h"
+
+#include <numeric>
+#include <cstdio>
+#include <algorithm>
+
+namespace Expanse::ecs
+{
+	WorldStats World::GetStats() const
+	{
+		WorldStats stats;
+
+		// free slots never store their own index
+		stats.entities.slots = entities.size();
+		for (size_t idx = 0; idx < entities.size(); ++idx)
+		{
+			if (entities[idx].entity.Index() == idx) {
+				++stats.entities.live;
+			}
+		}
+		stats.entities.free = stats.entities.slots - stats.entities.live;
+		stats.entities.version_overflows = version_overflows;
+		stats.entities.bytes = entities.capacity() * sizeof(EntityStore);
+
+		for (size_t type_index = 0; type_index < comp_stores.size(); ++type_index)
+		{
+			if (const auto& store = comp_stores[type_index])
+			{
+				auto& store_stats = stats.stores.emplace_back(store->GetStats());
+				store_stats.name = TypeRegistry<_ComponentsTypeFamily>::NameOf(type_index);
+			}
+		}
+
+		return stats;
+	}
+
+	size_t WorldStats::TotalBytesUsed() const
+	{
+		return std::accumulate(stores.begin(), stores.end(), entities.bytes, [](size_t sum, const StoreStats& store) { return sum + store.bytes_used; });
+	}
+
+	size_t WorldStats::TotalBytesWasted() const
+	{
+		return std::accumulate(stores.begin(), stores.end(), size_t{ 0 }, [](size_t sum, const StoreStats& store) { return sum + store.bytes_wasted; });
+	}
+
+	size_t WorldStats::TotalBytesCached() const
+	{
+		return std::accumulate(stores.begin(), stores.end(), size_t{ 0 }, [](size_t sum, const StoreStats& store) { return sum + store.bytes_cached; });
+	}
+
+	namespace
+	{
+		template<typename... Args>
+		void AppendFormatted(std::string& text, const char* format, const Args&... args)
+		{
+			char line[256];
+			const int length = std::snprintf(line, sizeof(line), format, args...);
+			text.append(line, std::min(static_cast<size_t>(std::max(length, 0)), sizeof(line) - 1));
+		}
+	}
+
+	std::string FormatStats(const WorldStats& stats)
+	{
+		const auto& ents = stats.entities;
+
+		std::string text;
+		AppendFormatted(text, "Entities: %zu live, %zu free, %zu slots, %zu version overflows, %.1f KB\n",
+			ents.live, ents.free, ents.slots, ents.version_overflows, ents.bytes / 1024.0);
+		AppendFormatted(text, "Stores: %.1f KB used, %.1f KB wasted, %.1f KB cached\n",
+			stats.TotalBytesUsed() / 1024.0, stats.TotalBytesWasted() / 1024.0, stats.TotalBytesCached() / 1024.0);
+
+		AppendFormatted(text, "%-48s %10s %10s %12s %12s %12s %8s %8s\n", "Component", "Size", "Capacity", "Used, KB", "Wasted, KB", "Cached, KB", "Adds", "Removes");
+		for (const auto& store : stats.stores)
+		{
+			const std::string name{ store.name };
+			AppendFormatted(text, "%-48s %10zu %10zu %12.1f %12.1f %12.1f %8zu %8zu\n", name.c_str(), store.size, store.capacity,
+				store.bytes_used / 1024.0, store.bytes_wasted / 1024.0, store.bytes_cached / 1024.0, store.frame_adds, store.frame_removes);
+		}
+		return text;
+	}
+}
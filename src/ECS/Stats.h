@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+namespace Expanse::ecs
+{
+	/*
+	* Memory and churn of a single component store.
+	* Memory includes components, dense entities, change ticks and sparse pages,
+	* wasted memory is allocated, but not used by live components.
+	* Cached memory is not owned by the store, it is freed by World::ShrinkToFit.
+	*/
+	struct StoreStats
+	{
+		std::string_view name;
+		size_t size = 0;
+		size_t capacity = 0;			// components, which fit into allocated pages
+		size_t bytes_used = 0;
+		size_t bytes_wasted = 0;
+		size_t bytes_cached = 0;		// free pages kept for reuse by the allocator of the component type
+		size_t frame_adds = 0;			// during the last complete frame
+		size_t frame_removes = 0;
+	};
+
+	struct EntityStats
+	{
+		size_t slots = 0;
+		size_t live = 0;
+		size_t free = 0;
+		size_t version_overflows = 0;	// freed slots, which version wrapped around, so stale handles may match again
+		size_t bytes = 0;
+	};
+
+	struct WorldStats
+	{
+		EntityStats entities;
+		std::vector<StoreStats> stores;		// only stores, which were created
+
+		size_t TotalBytesUsed() const;
+		size_t TotalBytesWasted() const;
+		size_t TotalBytesCached() const;
+	};
+
+	// Multi-line text table, for logs and bug reports
+	std::string FormatStats(const WorldStats& stats);
+}
@@ -1,5 +1,12 @@
 #pragma once
 
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <bit>
+#include <algorithm>
+
 namespace Expanse::ecs
 {
 	namespace details
@@ -16,4 +23,177 @@ namespace Expanse::ecs
 
 	template<class TypeFamily>
 	[[nodiscard]] size_t GetNextTypeIndex() { return details::TypeIndexCounter<TypeFamily>::Next(); }
-}
\ No newline at end of file
+
+	/*
+	* Name of type T as spelled by the compiler, e.g. "Expanse::Game::Terrain::TerrainChunk".
+	* MSVC spells class keys too, they are stripped.
+	*/
+	template<class T>
+	[[nodiscard]] constexpr std::string_view TypeName() noexcept
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		constexpr std::string_view signature = __FUNCSIG__;
+		constexpr auto begin = signature.find("TypeName<") + 9;
+		constexpr auto end = signature.rfind(">(void)");
+		auto name = signature.substr(begin, end - begin);
+		for (const std::string_view key : { "struct ", "class ", "enum ", "union " }) {
+			if (name.starts_with(key)) name.remove_prefix(key.size());
+		}
+		return name;
+#else
+		constexpr std::string_view signature = __PRETTY_FUNCTION__;
+		constexpr auto begin = signature.find("T = ") + 4;
+		constexpr auto end = signature.find_first_of(";]", begin);
+		return signature.substr(begin, end - begin);
+#endif
+	}
+
+	/*
+	* Identifier of type, computed at compile time from its name, so it doesn't depend on
+	* order in which types are used and is the same in every build. Used to tag serialized data.
+	*
+	* Names are spelled by the compiler, so ids are only guaranteed to match between builds made with the same one.
+	* Plain types in named namespaces are spelled the same by MSVC, GCC and Clang, templates and types
+	* in anonymous namespaces are not, e.g. because of spaces between template arguments.
+	*/
+	using TypeId = uint64_t;
+
+	// FNV-1a
+	[[nodiscard]] constexpr TypeId HashTypeName(std::string_view name) noexcept
+	{
+		TypeId hash = 0xcbf29ce484222325ull;
+		for (const char c : name)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	template<class T>
+	inline constexpr TypeId TypeIdOf = HashTypeName(TypeName<T>());
+
+	/*
+	* Maps type ids of a family to dense indices, which are assigned in registration order.
+	* Reverse lookup goes through a perfect hash table, which is rebuilt on registration:
+	* it is a single multiplication and comparison, without probing.
+	* Types are registered during static initialization, so lookups don't lock.
+	*/
+	template<class TypeFamily>
+	class TypeRegistry
+	{
+	public:
+		static constexpr size_t NullIndex = static_cast<size_t>(-1);
+
+		// Returns dense index of type id, assigning the next one on first call
+		static size_t Register(TypeId id, std::string_view name)
+		{
+			auto& data = GetData();
+
+			if (const auto idx = IndexOf(id); idx != NullIndex)
+			{
+				assert(data.names[idx] == name && "Type id collision");
+				return idx;
+			}
+
+			data.ids.push_back(id);
+			data.names.push_back(name);
+			Rebuild(data);
+			return data.ids.size() - 1;
+		}
+
+		[[nodiscard]] static size_t IndexOf(TypeId id) noexcept
+		{
+			const auto& data = GetData();
+			if (data.slots.empty()) return NullIndex;
+
+			const auto idx = data.slots[Slot(id, data.seed, data.shift)];
+			return (idx != NullIndex && data.ids[idx] == id) ? idx : NullIndex;
+		}
+
+		[[nodiscard]] static TypeId IdOf(size_t index) noexcept
+		{
+			return GetData().ids[index];
+		}
+
+		[[nodiscard]] static std::string_view NameOf(size_t index) noexcept
+		{
+			return GetData().names[index];
+		}
+
+		[[nodiscard]] static size_t Count() noexcept
+		{
+			return GetData().ids.size();
+		}
+
+	private:
+		struct Data
+		{
+			std::vector<TypeId> ids;		// indexed by dense index
+			std::vector<std::string_view> names;
+			std::vector<size_t> slots;		// dense indices, indexed by hash slot
+			uint64_t seed = 0;
+			int shift = 64;
+		};
+
+		// constructed on first use, registration may happen during static initialization of other TUs
+		static Data& GetData() noexcept
+		{
+			static Data data;
+			return data;
+		}
+
+		static size_t Slot(TypeId id, uint64_t seed, int shift) noexcept
+		{
+			return static_cast<size_t>(((id ^ seed) * 0x9e3779b97f4a7c15ull) >> shift);
+		}
+
+		// Picks seed, for which all ids land in different slots. Table has n^2 slots,
+		// so that a random seed succeeds with probability of at least 1/2.
+		static void Rebuild(Data& data)
+		{
+			const auto count = data.ids.size();
+			const auto table_size = std::bit_ceil(std::max<size_t>(16, count * count));
+			data.shift = 64 - std::countr_zero(table_size);
+
+			for (uint64_t seed = 0;; ++seed)
+			{
+				data.slots.assign(table_size, NullIndex);
+
+				bool collision = false;
+				for (size_t idx = 0; idx < count && !collision; ++idx)
+				{
+					auto& slot = data.slots[Slot(data.ids[idx], seed, data.shift)];
+					collision = (slot != NullIndex);
+					slot = idx;
+				}
+
+				if (!collision)
+				{
+					data.seed = seed;
+					return;
+				}
+			}
+		}
+	};
+
+	struct _ComponentsTypeFamily {};
+
+	// Stable id of component type, same in all builds
+	template<class Comp>
+	inline constexpr TypeId ComponentTypeId = TypeIdOf<Comp>;
+
+	/*
+	* Dense index of component type, shared by all world storages.
+	* It is not a compile-time constant: it is assigned during static initialization, in registration order,
+	* which differs between builds. Reading it is a load of a global, the id lookup is only used by snapshots.
+	*/
+	template<class Comp>
+	inline const size_t ComponentTypeIndex = TypeRegistry<_ComponentsTypeFamily>::Register(ComponentTypeId<Comp>, TypeName<Comp>());
+
+	// Dense index of component type by its id, NullIndex if no such type was registered
+	[[nodiscard]] inline size_t ComponentTypeIndexOf(TypeId id) noexcept
+	{
+		return TypeRegistry<_ComponentsTypeFamily>::IndexOf(id);
+	}
+}
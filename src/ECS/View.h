@@ -0,0 +1,257 @@
+#pragma once
+
+#include "ComponentStore.h"
+
+#include <tuple>
+#include <type_traits>
+#include <limits>
+
+namespace Expanse::ecs
+{
+	/*
+	* Exclusion filter for queries: entities having any of Comps are skipped
+	*
+	*	world.ForEach<TerrainChunk, Without<TerrainMesh>>(...)
+	*/
+	template<typename... Comps>
+	struct Without {};
+
+	/*
+	* Change filters for queries: only entities, which component was added (or added or
+	* accessed for writing) after the tick passed to the query, are visited.
+	* Component itself is not passed to the callback.
+	*
+	*	world.ForEach<const TerrainChunk, Added<TerrainChunk>>(func, since)
+	*/
+	template<typename Comp>
+	struct Added
+	{
+		using Component = std::remove_const_t<Comp>;
+
+		static bool CheckStore(const ComponentStoreBase& store, ChangeTick since) noexcept { return store.AnyAddedSince(since); }
+		static bool Check(const ComponentStoreBase& store, ComponentIndex idx, ChangeTick since) noexcept { return store.AddedSince(idx, since); }
+	};
+
+	template<typename Comp>
+	struct Changed
+	{
+		using Component = std::remove_const_t<Comp>;
+
+		static bool CheckStore(const ComponentStoreBase& store, ChangeTick since) noexcept { return store.AnyChangedSince(since); }
+		static bool Check(const ComponentStoreBase& store, ComponentIndex idx, ChangeTick since) noexcept { return store.ChangedSince(idx, since); }
+	};
+
+	namespace details
+	{
+		template<typename... Ts>
+		struct TypeList {};
+
+		template<typename List1, typename List2>
+		struct ConcatLists;
+
+		template<typename... Ts1, typename... Ts2>
+		struct ConcatLists<TypeList<Ts1...>, TypeList<Ts2...>> { using Type = TypeList<Ts1..., Ts2...>; };
+
+		/* Splits query arguments into lists of included and excluded component types and change filters */
+		template<typename... Args>
+		struct QueryArgs
+		{
+			using Included = TypeList<>;
+			using Excluded = TypeList<>;
+			using Filters = TypeList<>;
+		};
+
+		template<typename Arg, typename... Args>
+		struct QueryArgs<Arg, Args...>
+		{
+			using Included = typename ConcatLists<TypeList<Arg>, typename QueryArgs<Args...>::Included>::Type;
+			using Excluded = typename QueryArgs<Args...>::Excluded;
+			using Filters = typename QueryArgs<Args...>::Filters;
+		};
+
+		template<typename... Comps, typename... Args>
+		struct QueryArgs<Without<Comps...>, Args...>
+		{
+			using Included = typename QueryArgs<Args...>::Included;
+			using Excluded = typename ConcatLists<TypeList<Comps...>, typename QueryArgs<Args...>::Excluded>::Type;
+			using Filters = typename QueryArgs<Args...>::Filters;
+		};
+
+		template<typename Comp, typename... Args>
+		struct QueryArgs<Added<Comp>, Args...>
+		{
+			using Included = typename QueryArgs<Args...>::Included;
+			using Excluded = typename QueryArgs<Args...>::Excluded;
+			using Filters = typename ConcatLists<TypeList<Added<Comp>>, typename QueryArgs<Args...>::Filters>::Type;
+		};
+
+		template<typename Comp, typename... Args>
+		struct QueryArgs<Changed<Comp>, Args...>
+		{
+			using Included = typename QueryArgs<Args...>::Included;
+			using Excluded = typename QueryArgs<Args...>::Excluded;
+			using Filters = typename ConcatLists<TypeList<Changed<Comp>>, typename QueryArgs<Args...>::Filters>::Type;
+		};
+	}
+
+	template<typename Included, typename Excluded, typename Filters>
+	class BasicView;
+
+	/*
+	* Set of entities, that have all of the included components and none of the excluded ones,
+	* and pass all change filters.
+	* Iteration is driven by the smallest of included component stores, picked at runtime,
+	* all other stores are only probed.
+	* Const-qualified component types are passed to callbacks by const reference,
+	* others are marked as changed at the view tick.
+	*/
+	template<typename... Comps, typename... Excluded, typename... Filters>
+	class BasicView<details::TypeList<Comps...>, details::TypeList<Excluded...>, details::TypeList<Filters...>>
+	{
+		static_assert(sizeof...(Comps) > 0, "View must include at least one component type");
+
+	public:
+		using Stores = std::tuple<ComponentStore<std::remove_const_t<Comps>>*...>;
+		using ExcludedStores = std::tuple<ComponentStore<std::remove_const_t<Excluded>>*...>;
+		using FilterStores = std::tuple<ComponentStore<typename Filters::Component>*...>;
+
+		BasicView(Stores included, ExcludedStores excluded, FilterStores filtered = {}, ChangeTick tick_ = 0, ChangeTick since_ = 0)
+			: stores(included)
+			, excluded_stores(excluded)
+			, filter_stores(filtered)
+			, tick(tick_)
+			, since(since_)
+		{}
+
+		// True if none of the included stores is missing and filtered stores were touched since the query tick
+		bool IsValid() const noexcept
+		{
+			const bool has_stores = std::apply([](auto*... store) { return (... && (store != nullptr)); }, stores);
+			return has_stores && HasFilteredChanges(std::index_sequence_for<Filters...>{});
+		}
+
+		// Size of the store driving the iteration, upper bound of the number of matching entities
+		size_t SizeHint() const noexcept
+		{
+			const auto* driver = GetDriver();
+			return driver ? driver->Size() : 0;
+		}
+
+		bool Contains(Entity entity) const noexcept
+		{
+			if (!IsValid()) return false;
+
+			const bool has_all = std::apply([entity](auto*... store) { return (... && store->Contains(entity)); }, stores);
+			return has_all && !IsExcluded(entity) && PassesFilters(entity, std::index_sequence_for<Filters...>{});
+		}
+
+		// Calls func(entity, comps&...) for each entity in view
+		template<typename Func>
+		void ForEach(Func func) const
+		{
+			MarkStoresChanged();
+			ForEachInRange(func, 0, std::numeric_limits<size_t>::max());
+		}
+
+		// Same as ForEach, but only visits entities at positions [begin, end) of the driving store.
+		// MarkStoresChanged should be called once before visiting the ranges.
+		template<typename Func>
+		void ForEachInRange(Func& func, size_t begin, size_t end) const
+		{
+			const auto* driver = GetDriver();
+			if (!driver) return;
+
+			for (size_t i = begin; i < end && i < driver->entities.size(); ++i)
+			{
+				const auto entity = driver->entities[i];
+
+				const auto indices = std::apply([entity, driver, i](auto*... store) {
+					// position in the driving store is known, other stores are probed
+					return std::make_tuple((store == driver ? static_cast<ComponentIndex>(i) : store->IndexOf(entity))...);
+				}, stores);
+
+				if (!HasAllIndices(indices) || IsExcluded(entity) || !PassesFilters(entity, std::index_sequence_for<Filters...>{}))
+					continue;
+
+				CallWithComponents(func, entity, indices, std::index_sequence_for<Comps...>{});
+			}
+		}
+
+		// Updates store-wide change ticks of the stores, which are accessed for writing
+		void MarkStoresChanged() const noexcept
+		{
+			if (!IsValid()) return;
+
+			MarkStoresChangedImpl(std::index_sequence_for<Comps...>{});
+		}
+
+	private:
+		Stores stores;
+		ExcludedStores excluded_stores;
+		FilterStores filter_stores;
+
+		ChangeTick tick = 0;	// written components are marked with this tick
+		ChangeTick since = 0;	// change filters pass components touched after this tick
+
+		const ComponentStoreBase* GetDriver() const noexcept
+		{
+			if (!IsValid()) return nullptr;
+
+			const ComponentStoreBase* driver = std::get<0>(stores);
+			std::apply([&driver](auto*... store) {
+				((driver = (store->Size() < driver->Size()) ? store : driver), ...);
+			}, stores);
+			return driver;
+		}
+
+		bool IsExcluded(Entity entity) const noexcept
+		{
+			return std::apply([entity](auto*... store) { return (false || ... || (store && store->Contains(entity))); }, excluded_stores);
+		}
+
+		// Store-wide check, lets queries over untouched stores finish without visiting any entity
+		template<size_t... I>
+		bool HasFilteredChanges(std::index_sequence<I...>) const noexcept
+		{
+			return (true && ... && (std::get<I>(filter_stores) && Filters::CheckStore(*std::get<I>(filter_stores), since)));
+		}
+
+		template<size_t... I>
+		bool PassesFilters([[maybe_unused]] Entity entity, std::index_sequence<I...>) const noexcept
+		{
+			return (true && ... && PassesFilter<Filters>(std::get<I>(filter_stores), entity));
+		}
+
+		template<typename Filter>
+		bool PassesFilter(const ComponentStoreBase* store, Entity entity) const noexcept
+		{
+			return store->Contains(entity) && Filter::Check(*store, store->IndexOf(entity), since);
+		}
+
+		template<typename Indices>
+		static bool HasAllIndices(const Indices& indices) noexcept
+		{
+			return std::apply([](auto... idx) { return (... && (idx != NullComponentIndex)); }, indices);
+		}
+
+		template<size_t... I>
+		void MarkStoresChangedImpl(std::index_sequence<I...>) const noexcept
+		{
+			((std::is_const_v<Comps> ? void() : std::get<I>(stores)->MarkStoreChanged(tick)), ...);
+		}
+
+		template<typename Func, typename Indices, size_t... I>
+		void CallWithComponents(Func& func, Entity entity, const Indices& indices, std::index_sequence<I...>) const
+		{
+			((std::is_const_v<Comps> ? void() : std::get<I>(stores)->MarkChangedAt(std::get<I>(indices), tick)), ...);
+
+			func(entity, static_cast<Comps&>(*(std::get<I>(stores)->Get(std::get<I>(indices))))...);
+		}
+	};
+
+	template<typename... Args>
+	using View = BasicView<
+		typename details::QueryArgs<Args...>::Included,
+		typename details::QueryArgs<Args...>::Excluded,
+		typename details::QueryArgs<Args...>::Filters>;
+}
@@ -1,90 +1,164 @@
 #include "World.h"
 
-#include <ranges>
+#include <utility>
 
 namespace Expanse::ecs
 {
 	Entity World::CreateEntity()
 	{
-		if (free_entities.empty())
+		assert(parallel_sections == 0);
+
+		if (free_head == NullIndex)
 		{
+			assert(entities.size() < static_cast<size_t>(Entity::MaxIndex));
 			entities.emplace_back(entities.size());
 			return entities.back().entity;
 		}
 		else
 		{
-			const auto free_idx = free_entities.back();
-			free_entities.pop_back();
-			return entities[free_idx].entity;
+			// free slot keeps index of the next free slot and version for the next entity in it
+			auto& slot = entities[free_head];
+			const Entity entity{ free_head, slot.entity.Version() };
+			free_head = slot.entity.Index();
+			slot.entity = entity;
+			return entity;
 		}
 	}
 
 	void World::DestroyEntity(Entity entity)
 	{
 		assert(HasEntity(entity));
+		assert(parallel_sections == 0);
 
 		RemoveAllComponents(entity);
+		FreeSlot(entity);
+	}
+
+	void World::DestroyEntitiesBatch(const std::vector<Entity>& batch)
+	{
+		assert(parallel_sections == 0);
+		assert(std::ranges::all_of(batch, [this](Entity entity) { return HasEntity(entity); }));
+
+		// every store is visited once, instead of once per entity
+		std::vector<Entity> in_store;
+		for (auto& store : comp_stores)
+		{
+			if (!store || store->Size() == 0) continue;
+
+			in_store.clear();
+			for (const auto entity : batch)
+			{
+				if (store->Contains(entity)) {
+					in_store.push_back(entity);
+				}
+			}
+			store->RemoveMany(in_store);
+		}
+
+		for (const auto entity : batch) {
+			FreeSlot(entity);
+		}
+	}
+
+	void World::FreeSlot(Entity entity)
+	{
+		// also catches duplicates in batches
+		assert(HasEntity(entity));
 
 		const auto idx = entity.Index();
-		entities[idx].entity.IncVersion();
-		free_entities.push_back(idx);
+		entity.IncVersion();
+		if (entity.Version() == 0) {
+			++version_overflows;
+		}
+		entities[idx].entity = Entity{ free_head, entity.Version() };
+		free_head = idx;
 	}
 
 	bool World::HasEntity(Entity entity) const
 	{
+		// free slots never store their own index, so a single compare is enough
 		const auto idx = entity.Index();
-		return (idx < entities.size())
-			&& (entities[idx].entity == entity)
-			&& (std::ranges::find(free_entities, idx) == std::ranges::end(free_entities));
+		return (idx < entities.size()) && (entities[idx].entity == entity);
 	}
 
 	bool World::RemoveComponent(Entity entity, size_t comp_type)
 	{
 		assert(HasEntity(entity));
+		assert(parallel_sections == 0);
 
-		auto& ent = entities[entity.Index()];
+		if (comp_type >= comp_stores.size()) return false;
 
-		if (comp_type >= ent.components.size()) return false;
+		auto& store = comp_stores[comp_type];
+		return store && store->Remove(entity);
+	}
 
-		const auto comp_idx = ent.components[comp_type];
-		if (comp_idx == NullComponentIndex) return false;
+	void World::RemoveAllComponents(Entity entity)
+	{
+		assert(HasEntity(entity));
 
-		RemoveComponentFromStore(comp_type, comp_idx);
+		for (auto& store : comp_stores)
+		{
+			if (store) {
+				store->Remove(entity);
+			}
+		}
+	}
 
-		ent.components[comp_type] = NullComponentIndex;
+	void World::UpdateEvents()
+	{
+		assert(parallel_sections == 0);
 
-		return true;
+		for (auto& channel : event_channels)
+		{
+			if (channel) {
+				channel->Update();
+			}
+		}
 	}
 
-	void World::RemoveAllComponents(Entity entity)
+	void World::BeginFrame()
 	{
-		assert(HasEntity(entity));
-
-		auto& ent = entities[entity.Index()];
+		UpdateEvents();
 
-		for (const size_t comp_type : std::views::iota(0u, ent.components.size()))
+		for (auto& store : comp_stores)
 		{
-			const auto comp_idx = ent.components[comp_type];
-			if (comp_idx != NullComponentIndex)
-			{
-				RemoveComponentFromStore(comp_type, comp_idx);
+			if (store) {
+				store->RollFrameCounters();
 			}
 		}
+	}
 
-		ent.components.clear();
+	void World::ShrinkToFit()
+	{
+		for (auto& store : comp_stores)
+		{
+			if (store) {
+				store->ShrinkToFit();
+			}
+		}
 	}
 
-	void World::RemoveComponentFromStore(size_t comp_type, ComponentIndex comp_idx)
+	namespace
 	{
-		assert(comp_type < comp_stores.size());
+		using Factory = std::unique_ptr<ComponentStoreBase>(*)();
 
-		auto& store = comp_stores[comp_type];
+		std::vector<std::pair<TypeId, Factory>>& StoreFactories()
+		{
+			static std::vector<std::pair<TypeId, Factory>> factories;
+			return factories;
+		}
+	}
 
-		assert(store);
+	bool World::RegisterStoreFactory(TypeId type_id, StoreFactory factory)
+	{
+		StoreFactories().emplace_back(type_id, factory);
+		return true;
+	}
 
-		const Entity fix_ent = store->Remove(comp_idx);
-		if (fix_ent) {
-			entities[fix_ent.Index()].components[comp_type] = comp_idx;
-		}
+	World::StoreFactory World::FindStoreFactory(TypeId type_id)
+	{
+		const auto& factories = StoreFactories();
+		const auto itr = std::ranges::find(factories, type_id, [](const auto& entry) { return entry.first; });
+		return (itr != factories.end()) ? itr->second : nullptr;
 	}
 }
\ No newline at end of file
@@ -4,28 +4,24 @@
 #include "ComponentStore.h"
 #include "EntityStore.h"
 #include "AnyVector.h"
+#include "View.h"
+#include "Group.h"
+#include "Observer.h"
+#include "Events.h"
+#include "Stats.h"
+
+#include "Utils/Async.h"
 
 #include <memory>
+#include <atomic>
+#include <algorithm>
+#include <functional>
 
 namespace Expanse::ecs
 {
-	namespace details
-	{
-		/* Checks if all elements in tuple are not null */
-		template<typename Tuple>
-		bool HasAll(const Tuple& tup) noexcept {
-			return std::apply([](auto&&... v) { return (... && v); }, tup);
-		}
-
-		/* Checks if all component indices in tuple are not null */
-		template<typename IndexTuple>
-		bool HasAllComponents(const IndexTuple& comp_idx) noexcept {
-			return std::apply([](auto&&... v) { return (... && (v != NullComponentIndex)); }, comp_idx);
-		}
-	}
-
-	struct _ComponentsTypeFamily {};
 	struct _GlobalsTypeFamily {};
+	struct _GroupsTypeFamily {};
+	struct _EventsTypeFamily {};
 
 	using Globals = AnyVector<_GlobalsTypeFamily>;
 
@@ -36,12 +32,36 @@ namespace Expanse::ecs
 
 		void DestroyEntity(Entity entity);
 
-		template<typename EntityRange>
-		void DestroyEntities(EntityRange&& entities)
+		/*
+		* Creates count entities with copies of comps, each component store is filled in one pass:
+		*
+		*	world.CreateEntities(100, Position{}, Velocity{ 1.0f, 0.0f })
+		*/
+		template<typename... Comps>
+		std::vector<Entity> CreateEntities(size_t count, const Comps&... comps)
 		{
-			for (auto ent : entities) {
-				DestroyEntity(ent);
+			assert(parallel_sections == 0);
+
+			std::vector<Entity> result;
+			result.reserve(count);
+
+			if (free_head == NullIndex) {
+				entities.reserve(entities.size() + count);
 			}
+			for (size_t i = 0; i < count; ++i) {
+				result.push_back(CreateEntity());
+			}
+
+			(AddComponentToAll(result, comps), ...);
+			return result;
+		}
+
+		// Destroys all entities in range, components are removed store by store
+		template<typename EntityRange>
+		void DestroyEntities(EntityRange&& range)
+		{
+			std::vector<Entity> batch(std::ranges::begin(range), std::ranges::end(range));
+			DestroyEntitiesBatch(batch);
 		}
 
 		bool HasEntity(Entity entity) const;
@@ -50,23 +70,65 @@ namespace Expanse::ecs
 		Comp* AddComponent(Entity entity, Args&&... args)
 		{
 			assert(HasEntity(entity));
+			assert(parallel_sections == 0);
 
 			auto store = GetOrCreateStore<Comp>();
-			const auto comp_idx = store->Create(entity, std::forward<Args>(args)...);
-			entities[entity.Index()].SetComponent(CompTypeIndex<Comp>, comp_idx);
-			return store->Get(comp_idx);
+			return store->Create(entity, CurrentTick(), std::forward<Args>(args)...);
+		}
+
+		// Moves comps[i] to entity batch[i], the store is filled in one pass and observers are notified once
+		template<typename Comp>
+		void AddComponents(std::span<const Entity> batch, std::span<Comp> comps)
+		{
+			assert(parallel_sections == 0);
+			assert(std::ranges::all_of(batch, [this](Entity entity) { return HasEntity(entity); }));
+
+			if (batch.empty()) return;
+			GetOrCreateStore<Comp>()->CreateMany(batch, CurrentTick(), comps);
 		}
 
 		template<typename Comp>
 		bool RemoveComponent(Entity entity)
 		{
-			return RemoveComponent(entity, CompTypeIndex<Comp>);
+			return RemoveComponent(entity, ComponentTypeIndex<Comp>);
+		}
+
+		// Removes Comp from all listed entities, which have it, entities without it are dropped from the list.
+		// Components are removed from the end of the store, so that swaps touch the same memory.
+		template<typename Comp>
+		void RemoveComponents(std::vector<Entity>& entities)
+		{
+			assert(parallel_sections == 0);
+
+			auto store = GetStore<Comp>();
+			if (!store) return;
+
+			assert(std::ranges::all_of(entities, [this](Entity entity) { return HasEntity(entity); }));
+			std::erase_if(entities, [store](Entity entity) { return !store->Contains(entity); });
+			store->RemoveMany(entities);
 		}
 
+		// Non-const component is marked as changed, request const one to only read it:
+		//
+		//	world.GetComponent<const TerrainChunk>(entity)
 		template<typename Comp>
 		Comp* GetComponent(Entity entity)
 		{
-			return GetComponentImpl<Comp>(entity);
+			if constexpr (std::is_const_v<Comp>)
+			{
+				return GetComponentImpl<std::remove_const_t<Comp>>(entity);
+			}
+			else
+			{
+				assert(HasEntity(entity));
+
+				auto store = GetStore<Comp>();
+				if (!store || !store->Contains(entity)) return nullptr;
+
+				const auto idx = store->IndexOf(entity);
+				store->MarkChanged(idx, CurrentTick());
+				return store->Get(idx);
+			}
 		}
 
 		template<typename Comp, typename... Args>
@@ -82,7 +144,7 @@ namespace Expanse::ecs
 		template<typename Comp>
 		const Comp* GetComponent(Entity entity) const
 		{
-			return GetComponentImpl<Comp>(entity);
+			return GetComponentImpl<std::remove_const_t<Comp>>(entity);
 		}
 
 		template<typename... Comps>
@@ -98,20 +160,65 @@ namespace Expanse::ecs
 		}
 
 		template<typename Comp>
-		const std::vector<Comp>& GetComponentArray() const
+		const PagedVector<Comp>& GetComponentArray() const
 		{
 			auto store = GetStore<Comp>();
 
-			static std::vector<Comp> empty{};
+			static const PagedVector<Comp> empty{};
 			return store ? store->GetAll() : empty;
 		}
 
+		// Allocates memory for at least capacity components of type Comp
+		template<typename Comp>
+		void Reserve(size_t capacity)
+		{
+			GetOrCreateStore<Comp>()->Reserve(capacity);
+		}
+
+		template<typename Comp>
+		void SetShrinkPolicy(ComponentStoreBase::ShrinkPolicy policy)
+		{
+			GetOrCreateStore<Comp>()->SetShrinkPolicy(policy);
+		}
+
+		// Frees memory of removed components in all stores and returns cached pages of their types to the system
+		void ShrinkToFit();
+
+		/*
+		* Writes binary snapshot of entities and components, see Snapshot.h for the format.
+		* Only components, which opted in with SnapshotComponent, are saved, groups and events are not.
+		*/
+		void WriteSnapshot(BinaryWriter& out) const;
+
+		/*
+		* Restores entities and components from snapshot into world without entities,
+		* restored components are marked as added at the current tick.
+		* Returns false if data is corrupted, world should be discarded then.
+		*/
+		bool ReadSnapshot(BinaryReader& in);
+
+		/*
+		* Sorts components of type Comp in place with compare(const Comp&, const Comp&), so that
+		* ForEach driven by this store visits them in sorted order. Entities owned by a group are
+		* left in place, Group<...>().Sort<Comp>(...) sorts them.
+		*/
+		template<typename Comp, typename Compare>
+		void Sort(Compare compare, SortMode mode = SortMode::Full)
+		{
+			assert(parallel_sections == 0);
+
+			if (auto store = GetStore<Comp>()) {
+				store->Sort(compare, mode);
+			}
+		}
+
 		template<typename Comp>
 		bool HasComponent(Entity entity) const
 		{
 			assert(HasEntity(entity));
 
-			return entities[entity.Index()].HasComponent(CompTypeIndex<Comp>);
+			const auto store = GetStore<Comp>();
+			return store && store->Contains(entity);
 		}
 
 		template<typename... Comp>
@@ -136,27 +243,163 @@ namespace Expanse::ecs
 			return store ? store->entities : empty;
 		}
 
-		template<typename Comp, typename... Comps, typename Func>
-		void ForEach(Func func)
+		/*
+		* Returns view of entities having all of the listed components, Without<...> arguments exclude components,
+		* Added<...> and Changed<...> ones only pass components touched after since tick:
+		*
+		*	world.View<TerrainChunk, Without<TerrainMesh>>()
+		*	world.View<const TerrainChunk, Added<TerrainChunk>>(last_tick)
+		*/
+		template<typename... Args>
+		auto View(ChangeTick since = 0)
+		{
+			using Query = details::QueryArgs<Args...>;
+			using ViewType = ecs::View<Args...>;
+			return ViewType{
+				GetStoresTuple(typename Query::Included{}),
+				GetStoresTuple(typename Query::Excluded{}),
+				GetFilterStoresTuple(typename Query::Filters{}),
+				CurrentTick(),
+				since
+			};
+		}
+
+		// Calls func(entity, comps&...) for each entity, matching View<Args...>
+		template<typename... Args, typename Func>
+		void ForEach(Func func, ChangeTick since = 0)
 		{
-			// first, find stores for all mentioned components
-			auto stores = GetComponentStores<Comp, Comps...>();
-			if (!details::HasAll(stores)) return;
+			View<Args...>(since).ForEach(func);
+		}
 
-			for (const auto ent : GetEntitiesWith<Comp>())
+		/*
+		* Same as ForEach, but the driving store is split into ranges of grain entities, processed on the thread pool.
+		* Components, which func only reads, should be declared const:
+		*
+		*	world.ParallelForEach<Velocity, const Position>(...)
+		*
+		* func is called concurrently and must only touch components passed to it.
+		* Structural changes are not allowed until it returns, they have to be collected and applied afterwards.
+		*/
+		template<typename... Args, typename Func>
+		void ParallelForEach(Func func, size_t grain = DefaultParallelGrain, ChangeTick since = 0)
+		{
+			const auto view = View<Args...>(since);
+			view.MarkStoresChanged();
+
+			++parallel_sections;
+			utils::ParallelFor(view.SizeHint(), grain, [&view, &func](size_t begin, size_t end) {
+				view.ForEachInRange(func, begin, end);
+			});
+			--parallel_sections;
+		}
+
+		static constexpr size_t DefaultParallelGrain = 1024;
+
+		/*
+		* Returns handle to persistent group of entities having all of the Comps, creating it on first call.
+		* Group is updated on every add and remove, so iterating it doesn't probe any stores.
+		* Const and non-const Comps share the same group:
+		*
+		*	world.Group<const TerrainMesh, const TerrainChunk>().ForEach(...)
+		*
+		* Creating a group is a structural change, so groups should be created before systems are run concurrently,
+		* e.g. in system constructors.
+		*/
+		template<typename... Comps>
+		ecs::Group<Comps...> Group()
+		{
+			using Storage = typename ecs::Group<Comps...>::Storage;
+			const auto group_index = GroupTypeIndex<std::remove_const_t<Comps>...>;
+
+			groups.resize(std::max(groups.size(), group_index + 1));
+
+			auto& group = groups[group_index];
+			if (!group)
 			{
-				const auto indices = GetComponentIndices<Comp, Comps...>(ent);
-				if (details::HasAllComponents(indices)) {
-					std::apply(func, GetComponentsTuple(ent, stores, indices));
-				}
+				assert(parallel_sections == 0);
+				group = std::make_unique<Storage>(GetOrCreateStore<std::remove_const_t<Comps>>()...);
+			}
+
+			return { static_cast<Storage&>(*group), CurrentTick() };
+		}
+
+		/*
+		* Returns channel of events of type T, creating it on first call.
+		* Channels should be created before systems are run concurrently, e.g. in system constructors.
+		*/
+		template<typename T>
+		Events<T>& GetEvents()
+		{
+			const auto events_index = EventsTypeIndex<T>;
+
+			event_channels.resize(std::max(event_channels.size(), events_index + 1));
+
+			auto& channel = event_channels[events_index];
+			if (!channel) {
+				channel = std::make_unique<Events<T>>();
+			}
+
+			return static_cast<Events<T>&>(*channel);
+		}
+
+		/*
+		* Registers observer of Comp, which is called with batches of entities after they got Comp.
+		* Batch operations, e.g. CreateEntities or snapshot reading, call it once for the whole batch:
+		*
+		*	world.OnAdd<TerrainChunk>([](const ObservedBatch<TerrainChunk>& batch) { ... });
+		*
+		* Observers must not add or remove Comp, other structural changes are allowed.
+		*/
+		template<typename Comp, typename Func>
+		ObserverId OnAdd(Func func)
+		{
+			return AddObserver<Comp>(ObserverEvent::Add, std::move(func));
+		}
+
+		// Same as OnAdd, but observer is called before Comp is removed or its entity is destroyed
+		template<typename Comp, typename Func>
+		ObserverId OnRemove(Func func)
+		{
+			return AddObserver<Comp>(ObserverEvent::Remove, std::move(func));
+		}
+
+		template<typename Comp>
+		void RemoveObserver(ObserverId id)
+		{
+			assert(parallel_sections == 0);
+
+			if (auto store = GetStore<Comp>()) {
+				store->RemoveObserver(id);
 			}
 		}
+
+		// Starts new frame for all event channels, must not be called while systems are running
+		void UpdateEvents();
+
+		// Starts new frame: updates event channels and per-frame statistics
+		void BeginFrame();
+
+		// Memory and churn of entity table and component stores, walks the whole entity table
+		WorldStats GetStats() const;
+
+		ChangeTick CurrentTick() const { return current_tick.load(std::memory_order_relaxed); }
+
+		/*
+		* Starts new tick and returns the previous one, may be called by concurrently running systems.
+		* Systems keep the returned tick to only process components, which were touched since their last update:
+		*
+		*	const auto since = std::exchange(last_tick, world.AdvanceTick());
+		*	world.ForEach<const TerrainChunk, Added<TerrainChunk>>(func, since);
+		*/
+		ChangeTick AdvanceTick() { return current_tick.fetch_add(1, std::memory_order_relaxed); }
 	protected:
 
 		template<typename Comp>
 		ComponentStore<Comp>* GetOrCreateStore()
 		{
-			const auto type_index = CompTypeIndex<Comp>;
+			static_cast<void>(StoreFactoryRegistered<Comp>);
+
+			const auto type_index = ComponentTypeIndex<Comp>;
 
 			comp_stores.resize(std::max(comp_stores.size(), type_index + 1));
 
@@ -171,7 +414,7 @@ namespace Expanse::ecs
 		template<typename Comp>
 		ComponentStore<Comp>* GetStore() const
 		{
-			const auto type_index = CompTypeIndex<Comp>;
+			const auto type_index = ComponentTypeIndex<Comp>;
 			ComponentStoreBase* store = (type_index < comp_stores.size()) ? comp_stores[type_index].get() : nullptr;
 			return static_cast<ComponentStore<Comp>*>(store);
 		}
@@ -181,59 +424,86 @@ namespace Expanse::ecs
 		{
 			assert(HasEntity(entity));
 
-			const auto type_index = CompTypeIndex<Comp>;
-
-			auto& comps = entities[entity.Index()].components;
-			if (type_index >= comps.size()) return nullptr;
-
-			const auto comp_idx = comps[type_index];
-			if (comp_idx == NullComponentIndex) return nullptr;
-
 			auto store = GetStore<Comp>();
-			assert(store);
-			return store ? store->Get(comp_idx) : nullptr;
+			return store ? store->Find(entity) : nullptr;
 		}
 
-
 		template<typename... Comps>
-		auto GetComponentIndices(Entity entity) const noexcept
+		auto GetStoresTuple(details::TypeList<Comps...>) const
 		{
-			const auto& ent = entities[entity.Index()];
-			return std::make_tuple( (ent.GetComponentIndex(CompTypeIndex<Comps>))... );
+			return std::make_tuple( (GetStore<std::remove_const_t<Comps>>())... );
 		}
 
-		template<typename... Comps>
-		auto GetComponentStores() const
+		template<typename... Filters>
+		auto GetFilterStoresTuple(details::TypeList<Filters...>) const
 		{
-			return std::make_tuple( (GetStore<Comps>())... );
+			return std::make_tuple( (GetStore<typename Filters::Component>())... );
 		}
 
-		template<class Stores, class Indices, size_t... I>
-		auto GetComponentsTupleImpl(Entity entity, Stores&& stores, Indices&& indices, std::index_sequence<I...>)
+		bool RemoveComponent(Entity entity, size_t comp_type);
+		void RemoveAllComponents(Entity entity);
+
+		void DestroyEntitiesBatch(const std::vector<Entity>& batch);
+
+		// Puts slot of destroyed entity to the free list
+		void FreeSlot(Entity entity);
+
+		template<typename Comp>
+		void AddComponentToAll(const std::vector<Entity>& batch, const Comp& comp)
 		{
-			return std::make_tuple(entity, (std::ref(*(std::get<I>(stores)->Get(std::get<I>(indices)))))...);
+			GetOrCreateStore<Comp>()->CreateMany(batch, CurrentTick(), comp);
 		}
 
-		// Returns a tuple consisting of entity and references to components, specified by component stores and component indices
-		template<class Stores, class Indices>
-		auto GetComponentsTuple(Entity entity, Stores&& stores, Indices&& indices)
+		template<typename Comp, typename Func>
+		ObserverId AddObserver(ObserverEvent event, Func func)
 		{
-			return GetComponentsTupleImpl(entity,
-				std::forward<Stores>(stores),
-				std::forward<Indices>(indices),
-				std::make_index_sequence<std::tuple_size_v<std::remove_reference_t<Stores>>>());
-		}
+			assert(parallel_sections == 0);
 
-		bool RemoveComponent(Entity entity, size_t comp_type);
-		void RemoveAllComponents(Entity entity);
-		void RemoveComponentFromStore(size_t comp_type, ComponentIndex comp_idx);
+			auto store = GetOrCreateStore<Comp>();
+			return store->AddObserver(event, [store, func = std::move(func)](std::span<const Entity> batch) {
+				func(ObservedBatch<Comp>{ batch, *store });
+			});
+		}
 
 	protected:
 		std::vector<std::unique_ptr<ComponentStoreBase>> comp_stores;
 		std::vector<EntityStore> entities;
-		std::vector<size_t> free_entities;
 
-		template<class CompType>
-		static const size_t CompTypeIndex = GetNextTypeIndex<_ComponentsTypeFamily>();
+		// declared after stores, so that groups detach from stores before they are destroyed
+		std::vector<std::unique_ptr<StoreListener>> groups;
+
+		std::vector<std::unique_ptr<EventsBase>> event_channels;
+
+		// Head of the free slots list, threaded through EntityStore::entity of free slots
+		static constexpr auto NullIndex = Entity::MaxIndex;
+		Entity::BaseType free_head = NullIndex;
+
+		// Number of times version of a freed slot wrapped around
+		size_t version_overflows = 0;
+
+		// Number of running ParallelForEach calls, systems may run them concurrently.
+		// Structural changes are forbidden while it's not zero.
+		std::atomic<int> parallel_sections = 0;
+
+		// Added and written components are marked with it
+		std::atomic<ChangeTick> current_tick = 1;
+
+		using StoreFactory = std::unique_ptr<ComponentStoreBase>(*)();
+
+		// Creates stores of types, which are only known by id, e.g. while reading snapshot
+		static bool RegisterStoreFactory(TypeId type_id, StoreFactory factory);
+		static StoreFactory FindStoreFactory(TypeId type_id);
+
+		// keyed by id, not index, because it is initialized along with ComponentTypeIndex in unspecified order
+		template<typename Comp>
+		static inline const bool StoreFactoryRegistered = RegisterStoreFactory(ComponentTypeId<Comp>, [] {
+			return std::unique_ptr<ComponentStoreBase>(std::make_unique<ComponentStore<Comp>>());
+		});
+
+		template<typename... Comps>
+		static inline const size_t GroupTypeIndex = GetNextTypeIndex<_GroupsTypeFamily>();
+
+		template<typename T>
+		static inline const size_t EventsTypeIndex = GetNextTypeIndex<_EventsTypeFamily>();
 	};
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "DebugWindow.h"
 
 #include "Game/World.h"
+#include "Utils/Logger/Logger.h"
 
 #include "imgui.h"
 
@@ -15,5 +16,89 @@ namespace Expanse
 		ImGui::Begin("DebugInfo", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_NoTitleBar);
 		ImGui::Text("FPS: %d", fps);
 		ImGui::End();
+
+		ShowSystemTimings();
+		ShowEcsStats();
+	}
+
+	void DebugWindowSystem::ShowSystemTimings()
+	{
+		if (!profiled_systems) return;
+
+		ImGui::Begin("Systems");
+		ImGui::Text("Update: %.2f ms, critical path: %.2f ms",
+			profiled_systems->GetUpdateTime() * 1000.0f, profiled_systems->GetCriticalPathTime() * 1000.0f);
+
+		if (ImGui::BeginTable("SystemTimings", 3))
+		{
+			ImGui::TableSetupColumn("System");
+			ImGui::TableSetupColumn("ms");
+			ImGui::TableSetupColumn("Thread");
+			ImGui::TableHeadersRow();
+
+			// systems on critical path are highlighted
+			for (const auto& timing : profiled_systems->GetTimings())
+			{
+				const auto color = timing.on_critical_path ? ImVec4(1.0f, 0.6f, 0.2f, 1.0f) : ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextColored(color, "%s", timing.name.c_str());
+				ImGui::TableNextColumn();
+				ImGui::TextColored(color, "%.3f", timing.time * 1000.0f);
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(timing.main_thread ? "main" : "pool");
+			}
+			ImGui::EndTable();
+		}
+		ImGui::End();
+	}
+
+	void DebugWindowSystem::ShowEcsStats()
+	{
+		const auto stats = world.entities.GetStats();
+		const auto& ents = stats.entities;
+
+		ImGui::Begin("ECS");
+		ImGui::Text("Entities: %zu live, %zu free, %zu version overflows", ents.live, ents.free, ents.version_overflows);
+		ImGui::Text("Memory: %.1f KB used, %.1f KB wasted", stats.TotalBytesUsed() / 1024.0, stats.TotalBytesWasted() / 1024.0);
+
+		if (ImGui::Button("Dump to log")) {
+			Log::message(ecs::FormatStats(stats));
+		}
+
+		if (ImGui::BeginTable("StoreStats", 6))
+		{
+			ImGui::TableSetupColumn("Component");
+			ImGui::TableSetupColumn("Size");
+			ImGui::TableSetupColumn("Used, KB");
+			ImGui::TableSetupColumn("Wasted, KB");
+			ImGui::TableSetupColumn("Adds");
+			ImGui::TableSetupColumn("Removes");
+			ImGui::TableHeadersRow();
+
+			// stores, which waste more than they use, are highlighted
+			for (const auto& store : stats.stores)
+			{
+				const bool bloated = store.bytes_wasted > store.bytes_used;
+				const auto color = bloated ? ImVec4(1.0f, 0.6f, 0.2f, 1.0f) : ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextColored(color, "%.*s", static_cast<int>(store.name.size()), store.name.data());
+				ImGui::TableNextColumn();
+				ImGui::Text("%zu", store.size);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", store.bytes_used / 1024.0);
+				ImGui::TableNextColumn();
+				ImGui::TextColored(color, "%.1f", store.bytes_wasted / 1024.0);
+				ImGui::TableNextColumn();
+				ImGui::Text("%zu", store.frame_adds);
+				ImGui::TableNextColumn();
+				ImGui::Text("%zu", store.frame_removes);
+			}
+			ImGui::EndTable();
+		}
+		ImGui::End();
 	}
 }
\ No newline at end of file
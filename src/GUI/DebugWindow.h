@@ -7,10 +7,20 @@ namespace Expanse
 	class DebugWindowSystem final : public Game::ISystem
 	{
 	public:
-		explicit DebugWindowSystem(Game::World& w)
+		DebugWindowSystem(Game::World& w, const Game::SystemCollection* systems)
 			: Game::ISystem(w)
-		{}
+			, profiled_systems(systems)
+		{
+			// ECS stats read all stores, so the system must not run along with systems touching them
+			access.MainThread().Structural();
+		}
 
 		void Update() override;
+
+	private:
+		const Game::SystemCollection* profiled_systems = nullptr;
+
+		void ShowSystemTimings();
+		void ShowEcsStats();
 	};
 }
\ No newline at end of file
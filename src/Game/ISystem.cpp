@@ -0,0 +1,259 @@
+#include "pch.h"
+
+#include "ISystem.h"
+
+#include "Utils/Async.h"
+#include "Utils/Timers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace Expanse::Game
+{
+	bool SystemAccess::WritesAnyOf(const SystemAccess& other) const
+	{
+		auto touched_by_other = [&other](const std::type_index& type) {
+			return std::ranges::find(other.reads, type) != other.reads.end()
+				|| std::ranges::find(other.writes, type) != other.writes.end();
+		};
+		return std::ranges::any_of(writes, touched_by_other);
+	}
+
+	bool SystemAccess::ConflictsWith(const SystemAccess& other) const
+	{
+		if (!declared || !other.declared)
+			return true;
+
+		// main thread systems keep their order, which matters for rendering
+		if (main_thread && other.main_thread)
+			return true;
+
+		// structural changes reorder component stores and entity table
+		if ((structural && other.TouchesAnything()) || (other.structural && TouchesAnything()))
+			return true;
+
+		return WritesAnyOf(other) || other.WritesAnyOf(*this);
+	}
+
+	void SystemAccess::Merge(const SystemAccess& other)
+	{
+		reads.insert(reads.end(), other.reads.begin(), other.reads.end());
+		writes.insert(writes.end(), other.writes.begin(), other.writes.end());
+		structural |= other.structural;
+		main_thread |= other.main_thread || !other.declared;
+		declared = true;
+	}
+
+	/*************************************************************************************************/
+
+	void SystemCollection::AddNode(SystemPtr system, std::string name)
+	{
+		// keep only class name, without namespaces
+		if (const auto pos = name.rfind("::"); pos != std::string::npos) {
+			name = name.substr(pos + 2);
+		}
+
+		// collection runs all its children, so it inherits their access
+		access.Merge(system->GetAccess());
+
+		timings.push_back({ std::move(name), 0.0f, system->GetAccess().IsMainThread(), false });
+		nodes.push_back({ std::move(system), {}, {} });
+		graph_dirty = true;
+	}
+
+	void SystemCollection::BuildGraph()
+	{
+		// nested collections may get new children after they were added, so access is re-read here
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			nodes[i].predecessors.clear();
+			nodes[i].successors.clear();
+			timings[i].main_thread = nodes[i].system->GetAccess().IsMainThread();
+		}
+
+		for (size_t j = 0; j < nodes.size(); ++j)
+		{
+			for (size_t i = 0; i < j; ++i)
+			{
+				if (nodes[i].system->GetAccess().ConflictsWith(nodes[j].system->GetAccess()))
+				{
+					nodes[i].successors.push_back(j);
+					nodes[j].predecessors.push_back(i);
+				}
+			}
+		}
+
+		run_times.assign(nodes.size(), 0.0f);
+		graph_dirty = false;
+	}
+
+	void SystemCollection::Update()
+	{
+		if (graph_dirty) {
+			BuildGraph();
+		}
+
+		Timer timer;
+
+		if (parallel) {
+			RunGraph();
+		} else {
+			RunSequential();
+		}
+
+		update_time = timer.Elapsed();
+		PublishTimings();
+	}
+
+	void SystemCollection::RunNode(size_t idx)
+	{
+		Timer timer;
+		nodes[idx].system->Update();
+		run_times[idx] = timer.Elapsed();
+	}
+
+	void SystemCollection::RunSequential()
+	{
+		for (size_t i = 0; i < nodes.size(); ++i) {
+			RunNode(i);
+		}
+	}
+
+	void SystemCollection::RunGraph()
+	{
+		// shared with pool tasks, which may start after the update is over
+		struct RunState
+		{
+			std::mutex mutex;
+			std::condition_variable cv;
+			std::vector<size_t> finished;
+			std::unique_ptr<std::atomic<bool>[]> started;
+		};
+		auto state = std::make_shared<RunState>();
+		state->started = std::make_unique<std::atomic<bool>[]>(nodes.size());
+
+		std::vector<size_t> pending_deps(nodes.size());
+		std::vector<size_t> main_ready;
+		std::vector<size_t> pool_running;
+
+		auto make_ready = [&](size_t idx)
+		{
+			if (timings[idx].main_thread)
+			{
+				main_ready.push_back(idx);
+				return;
+			}
+
+			pool_running.push_back(idx);
+			utils::AsyncVoid([this, state, idx]
+			{
+				// system could already be picked up by the main thread
+				if (state->started[idx].exchange(true))
+					return;
+
+				RunNode(idx);
+				{
+					std::scoped_lock lock(state->mutex);
+					state->finished.push_back(idx);
+				}
+				state->cv.notify_one();
+			});
+		};
+
+		size_t done_count = 0;
+		auto complete = [&](size_t idx)
+		{
+			++done_count;
+			std::erase(pool_running, idx);
+			for (const auto succ : nodes[idx].successors)
+			{
+				if (--pending_deps[succ] == 0) {
+					make_ready(succ);
+				}
+			}
+		};
+
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			pending_deps[i] = nodes[i].predecessors.size();
+			if (pending_deps[i] == 0) {
+				make_ready(i);
+			}
+		}
+
+		while (done_count < nodes.size())
+		{
+			// run main thread systems first, then help with the pool ones
+			size_t local_idx = nodes.size();
+			if (!main_ready.empty())
+			{
+				local_idx = main_ready.front();
+				main_ready.erase(main_ready.begin());
+				state->started[local_idx] = true;
+			}
+			else
+			{
+				for (const auto idx : pool_running)
+				{
+					if (!state->started[idx].exchange(true)) {
+						local_idx = idx;
+						break;
+					}
+				}
+			}
+
+			if (local_idx < nodes.size())
+			{
+				RunNode(local_idx);
+				complete(local_idx);
+				continue;
+			}
+
+			std::vector<size_t> finished;
+			{
+				std::unique_lock lock(state->mutex);
+				state->cv.wait(lock, [&state] { return !state->finished.empty(); });
+				std::swap(finished, state->finished);
+			}
+			for (const auto idx : finished) {
+				complete(idx);
+			}
+		}
+	}
+
+	void SystemCollection::PublishTimings()
+	{
+		// nodes are stored in topological order, as edges always go from earlier systems to later ones
+		std::vector<float> finish_time(nodes.size(), 0.0f);
+		std::vector<size_t> critical_pred(nodes.size(), nodes.size());
+
+		size_t last = nodes.size();
+		critical_path_time = 0.0f;
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			float start = 0.0f;
+			for (const auto pred : nodes[i].predecessors)
+			{
+				if (finish_time[pred] > start) {
+					start = finish_time[pred];
+					critical_pred[i] = pred;
+				}
+			}
+			finish_time[i] = start + run_times[i];
+
+			if (finish_time[i] >= critical_path_time) {
+				critical_path_time = finish_time[i];
+				last = i;
+			}
+
+			timings[i].time = run_times[i];
+			timings[i].on_critical_path = false;
+		}
+
+		for (auto idx = last; idx < nodes.size(); idx = critical_pred[idx]) {
+			timings[idx].on_critical_path = true;
+		}
+	}
+}
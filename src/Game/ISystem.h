@@ -2,11 +2,71 @@
 
 #include <memory>
 #include <vector>
+#include <string>
+#include <typeindex>
 
 namespace Expanse::Game
 {
 	struct World;
 
+	/*
+	* Declares component, global and World field types that system reads and writes.
+	* Systems with conflicting access are run in order of addition, others may run concurrently.
+	* System, that declared nothing, conflicts with every other one.
+	*/
+	class SystemAccess
+	{
+	public:
+		template<typename... Ts>
+		SystemAccess& Read()
+		{
+			(reads.emplace_back(typeid(Ts)), ...);
+			declared = true;
+			return *this;
+		}
+
+		template<typename... Ts>
+		SystemAccess& Write()
+		{
+			(writes.emplace_back(typeid(Ts)), ...);
+			declared = true;
+			return *this;
+		}
+
+		// System creates or destroys entities, adds or removes components
+		SystemAccess& Structural()
+		{
+			structural = true;
+			declared = true;
+			return *this;
+		}
+
+		// System uses renderer, input or anything else, that is only accessible from the main thread
+		SystemAccess& MainThread()
+		{
+			main_thread = true;
+			declared = true;
+			return *this;
+		}
+
+		bool IsMainThread() const { return main_thread || !declared; }
+
+		bool ConflictsWith(const SystemAccess& other) const;
+
+		void Merge(const SystemAccess& other);
+
+	private:
+		std::vector<std::type_index> reads;
+		std::vector<std::type_index> writes;
+		bool structural = false;
+		bool main_thread = false;
+		bool declared = false;
+
+		bool TouchesAnything() const { return structural || !reads.empty() || !writes.empty(); }
+		bool WritesAnyOf(const SystemAccess& other) const;
+	};
+
+
 	class ISystem
 	{
 	public:
@@ -14,8 +74,11 @@ namespace Expanse::Game
 		virtual ~ISystem() = default;
 
 		virtual void Update() = 0;
+
+		const SystemAccess& GetAccess() const { return access; }
 	protected:
 		World& world;
+		SystemAccess access;
 	};
 
 
@@ -38,6 +101,21 @@ namespace Expanse::Game
 	};
 
 
+	// Timing of system during the last update
+	struct SystemTiming
+	{
+		std::string name;
+		float time = 0.0f; // seconds
+		bool main_thread = false;
+		bool on_critical_path = false;
+	};
+
+	/*
+	* Runs child systems as a dependency graph: system depends on all previously added systems
+	* it conflicts with. Systems without pending dependencies are run on the thread pool,
+	* main thread ones are run by the calling thread, which also picks up pool systems
+	* not started yet, while waiting.
+	*/
 	class SystemCollection : public ISystem
 	{
 		using SystemPtr = std::unique_ptr<ISystem>;
@@ -47,17 +125,51 @@ namespace Expanse::Game
 		template<class S = FunctionSystem, typename... Args> requires std::is_base_of_v<ISystem, S>
 		S* AddSystem(Args&&... args)
 		{
-			systems.push_back(std::make_unique<S>(world, std::forward<Args>(args)...));
-			return static_cast<S*>(systems.back().get());
-		}
+			auto system = std::make_unique<S>(world, std::forward<Args>(args)...);
+			auto* system_ptr = system.get();
 
-		void Update() override
-		{
-			for (auto& sys : systems) {
-				sys->Update();
-			}
+			AddNode(std::move(system), typeid(S).name());
+			return system_ptr;
 		}
+
+		void Update() override;
+
+		// When disabled, systems are run one by one in order of addition
+		void SetParallel(bool enable) { parallel = enable; }
+
+		const std::vector<SystemTiming>& GetTimings() const { return timings; }
+
+		// Longest chain of dependent systems during the last update, in seconds
+		float GetCriticalPathTime() const { return critical_path_time; }
+
+		// Wall time of the last update, in seconds
+		float GetUpdateTime() const { return update_time; }
+
 	private:
-		std::vector<SystemPtr> systems;
+		struct Node
+		{
+			SystemPtr system;
+			std::vector<size_t> predecessors;
+			std::vector<size_t> successors;
+		};
+
+		std::vector<Node> nodes;
+		bool graph_dirty = false;
+		bool parallel = true;
+
+		// times of the current update, published to timings when it's finished
+		std::vector<float> run_times;
+		std::vector<SystemTiming> timings;
+		float critical_path_time = 0.0f;
+		float update_time = 0.0f;
+
+		void AddNode(SystemPtr system, std::string name);
+		void BuildGraph();
+
+		void RunNode(size_t idx);
+		void RunSequential();
+		void RunGraph();
+
+		void PublishTimings();
 	};
-}
\ No newline at end of file
+}
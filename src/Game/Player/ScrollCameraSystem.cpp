@@ -10,6 +10,8 @@ namespace Expanse::Game::Player
 	ScrollCamera::ScrollCamera(World& w)
 		: ISystem(w)
 	{
+		// input state is updated on the main thread
+		access.MainThread().Write<Fields::Camera>();
 	}
 
 	void ScrollCamera::Update()
@@ -0,0 +1,55 @@
+#include "pch.h"
+
+#include "ChunkMap.h"
+
+#include <bit>
+
+namespace Expanse::Game::Terrain
+{
+	ChunkMap::ChunkMap(Point sz)
+		: size{ static_cast<int>(std::bit_ceil(static_cast<unsigned>(std::max(sz.x, 1)))),
+				static_cast<int>(std::bit_ceil(static_cast<unsigned>(std::max(sz.y, 1)))) }
+	{
+		cells.resize(static_cast<size_t>(size.x * size.y));
+	}
+
+	void ChunkMap::Insert(Point pos, ecs::Entity entity)
+	{
+		assert(entity);
+
+		// cell is taken by another live chunk, so map is too small for loaded area
+		while (cells[CellIndex(pos)].entity && cells[CellIndex(pos)].pos != pos) {
+			Grow(pos, cells[CellIndex(pos)].pos);
+		}
+
+		cells[CellIndex(pos)] = { pos, entity };
+		++generation;
+	}
+
+	void ChunkMap::Erase(Point pos, ecs::Entity entity)
+	{
+		auto& cell = cells[CellIndex(pos)];
+		if (cell.pos == pos && cell.entity == entity)
+		{
+			cell.entity = {};
+			++generation;
+		}
+	}
+
+	void ChunkMap::Grow(Point pos1, Point pos2)
+	{
+		// positions, which differ modulo old size, differ modulo doubled one too, so live chunks don't collide
+		const Point new_size = (pos1.x != pos2.x) ? Point{ size.x * 2, size.y } : Point{ size.x, size.y * 2 };
+
+		ChunkMap grown{ new_size };
+		for (const auto& cell : cells)
+		{
+			if (cell.entity) {
+				grown.cells[grown.CellIndex(cell.pos)] = cell;
+			}
+		}
+
+		cells = std::move(grown.cells);
+		size = new_size;
+	}
+}
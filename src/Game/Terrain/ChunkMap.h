@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Utils/Math.h"
+#include "ECS/Entity.h"
+
+#include <vector>
+#include <cstdint>
+
+namespace Expanse::Game::Terrain
+{
+	/*
+	* Index of loaded and loading chunks by position.
+	*
+	* Map is toroidal: chunk is stored in the cell at its position modulo map size, so as camera scrolls,
+	* new chunks take cells of the ones, which were unloaded, and map is never reallocated.
+	* It only grows when two live chunks fall into the same cell, i.e. loaded area doesn't fit anymore.
+	*
+	* Generation is increased on every change, so that users can cheaply check if anything was loaded or unloaded.
+	*/
+	class ChunkMap
+	{
+	public:
+		static constexpr Point DefaultSize = { 32, 32 };
+
+		// Size is rounded up to powers of two
+		explicit ChunkMap(Point size = DefaultSize);
+
+		// Returns null entity if there is no chunk at pos
+		ecs::Entity Find(Point pos) const
+		{
+			const auto& cell = cells[CellIndex(pos)];
+			return (cell.pos == pos) ? cell.entity : ecs::Entity{};
+		}
+
+		// Puts entity at pos, replacing the chunk, which was there
+		void Insert(Point pos, ecs::Entity entity);
+
+		// Removes chunk at pos, if it is the entity
+		void Erase(Point pos, ecs::Entity entity);
+
+		uint64_t Generation() const noexcept { return generation; }
+		Point Size() const noexcept { return size; }
+
+	private:
+		struct Cell
+		{
+			Point pos;
+			ecs::Entity entity;
+		};
+
+		std::vector<Cell> cells;
+		Point size;
+		uint64_t generation = 0;
+
+		// sizes are powers of two, so that masking works for negative coordinates too
+		size_t CellIndex(Point pos) const noexcept
+		{
+			return static_cast<size_t>((pos.y & (size.y - 1)) * size.x + (pos.x & (size.x - 1)));
+		}
+
+		void Grow(Point pos1, Point pos2);
+	};
+}
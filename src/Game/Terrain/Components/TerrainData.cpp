@@ -0,0 +1,171 @@
+#include "pch.h"
+
+#include "TerrainData.h"
+
+#include <array>
+#include <bit>
+
+namespace Expanse::Game::Terrain
+{
+	namespace
+	{
+		constexpr int WordBits = 64;
+
+		// Values don't cross word boundaries, zero bits means all values are zero and nothing is stored
+		class BitPacker
+		{
+		public:
+			BitPacker(std::vector<uint64_t>& words_, int bits_, size_t count)
+				: words(words_)
+				, bits(bits_)
+			{
+				words.clear();
+				if (bits > 0)
+				{
+					per_word = WordBits / bits;
+					words.resize((count + per_word - 1) / per_word, 0);
+				}
+			}
+
+			void Push(uint32_t value)
+			{
+				if (bits > 0) {
+					words[index / per_word] |= static_cast<uint64_t>(value) << ((index % per_word) * bits);
+				}
+				++index;
+			}
+
+		private:
+			std::vector<uint64_t>& words;
+			int bits = 0;
+			size_t per_word = 1;
+			size_t index = 0;
+		};
+
+		class BitUnpacker
+		{
+		public:
+			BitUnpacker(const std::vector<uint64_t>& words_, int bits_)
+				: words(words_)
+				, bits(bits_)
+				, per_word((bits_ > 0) ? WordBits / bits_ : 1)
+				, mask((uint64_t{ 1 } << bits_) - 1)
+			{}
+
+			uint32_t Pop()
+			{
+				const auto value = (bits > 0) ? (words[index / per_word] >> ((index % per_word) * bits)) & mask : 0;
+				++index;
+				return static_cast<uint32_t>(value);
+			}
+
+		private:
+			const std::vector<uint64_t>& words;
+			int bits = 0;
+			size_t per_word = 1;
+			uint64_t mask = 0;
+			size_t index = 0;
+		};
+
+		// Maps small differences of both signs to small unsigned values: 0, -1, 1, -2, 2...
+		uint32_t ZigZag(int value) { return static_cast<uint32_t>((value < 0) ? -2 * value - 1 : 2 * value); }
+		int UnZigZag(uint32_t value) { return (value & 1) ? -static_cast<int>(value / 2) - 1 : static_cast<int>(value / 2); }
+
+		// Left neighbour predicts height, first column is predicted by the vertex below
+		template<typename Func>
+		void ForEachHeightDelta(const Array2D<HeightType>& heights, Func func)
+		{
+			const auto rect = heights.GetRect();
+			for (int y = rect.y; y < rect.y + rect.h; ++y)
+			{
+				for (int x = rect.x; x < rect.x + rect.w; ++x)
+				{
+					if (x == rect.x && y == rect.y)
+						continue;
+
+					const Point prev = (x > rect.x) ? Point{ x - 1, y } : Point{ x, y - 1 };
+					func(heights[{ x, y }] - heights[prev]);
+				}
+			}
+		}
+	}
+
+	PackedTerrainCells::PackedTerrainCells(const TerrainCellsArray& cells)
+		: types_rect(cells.types.GetRect())
+		, heights_rect(cells.heights.GetRect())
+	{
+		if (cells.types.Empty() || cells.heights.Empty())
+			return;
+
+		// palette
+		std::array<bool, 256> used = {};
+		for (const auto type : cells.types) {
+			used[type] = true;
+		}
+
+		std::array<uint8_t, 256> palette_index = {};
+		for (size_t type = 0; type < used.size(); ++type)
+		{
+			if (used[type])
+			{
+				palette_index[type] = static_cast<uint8_t>(palette.size());
+				palette.push_back(static_cast<TerrainType>(type));
+			}
+		}
+
+		bits_per_type = std::bit_width(palette.size() - 1);
+		BitPacker types_packer{ type_indices, bits_per_type, cells.types.Size() };
+		for (const auto type : cells.types) {
+			types_packer.Push(palette_index[type]);
+		}
+
+		// heights
+		first_height = *cells.heights.begin();
+
+		uint32_t max_delta = 0;
+		ForEachHeightDelta(cells.heights, [&max_delta](int delta) { max_delta = std::max(max_delta, ZigZag(delta)); });
+
+		bits_per_height = std::bit_width(max_delta);
+		BitPacker heights_packer{ height_deltas, bits_per_height, cells.heights.Size() - 1 };
+		ForEachHeightDelta(cells.heights, [&heights_packer](int delta) { heights_packer.Push(ZigZag(delta)); });
+
+		palette.shrink_to_fit();
+	}
+
+	TerrainCellsArray PackedTerrainCells::Unpack() const
+	{
+		TerrainCellsArray cells;
+		if (palette.empty())
+			return cells;
+
+		cells.types = Array2D<TerrainType>{ types_rect };
+		BitUnpacker types_unpacker{ type_indices, bits_per_type };
+		for (auto& type : cells.types) {
+			type = palette[types_unpacker.Pop()];
+		}
+
+		cells.heights = Array2D<HeightType>{ heights_rect };
+		BitUnpacker heights_unpacker{ height_deltas, bits_per_height };
+		for (int y = heights_rect.y; y < heights_rect.y + heights_rect.h; ++y)
+		{
+			for (int x = heights_rect.x; x < heights_rect.x + heights_rect.w; ++x)
+			{
+				if (x == heights_rect.x && y == heights_rect.y)
+				{
+					cells.heights[{ x, y }] = first_height;
+					continue;
+				}
+
+				const Point prev = (x > heights_rect.x) ? Point{ x - 1, y } : Point{ x, y - 1 };
+				cells.heights[{ x, y }] = static_cast<HeightType>(cells.heights[prev] + UnZigZag(heights_unpacker.Pop()));
+			}
+		}
+
+		return cells;
+	}
+
+	size_t PackedTerrainCells::MemorySize() const
+	{
+		return sizeof(*this) + palette.capacity() * sizeof(TerrainType) + (type_indices.capacity() + height_deltas.capacity()) * sizeof(uint64_t);
+	}
+}
@@ -1,9 +1,14 @@
 #pragma once
 
 #include "Utils/Array2D.h"
+#include "Utils/BinaryStream.h"
 #include "ECS/Entity.h"
+#include "ECS/SnapshotTraits.h"
+#include "Game/Terrain/ChunkMap.h"
 
 #include <future>
+#include <optional>
+#include <vector>
 
 namespace Expanse::Game::Terrain
 {
@@ -25,6 +30,38 @@ namespace Expanse::Game::Terrain
 		{}
 	};
 
+	/*
+	* Compact copy of TerrainCellsArray for chunks, which are loaded but not visible.
+	*
+	* Types are replaced with indices into a palette of types, which occur in the chunk,
+	* and packed into 64-bit words with as few bits per cell as the palette needs, none if chunk has a single type.
+	* Heights are stored as differences from the left vertex (from the one below for the first column),
+	* packed the same way with as few bits as the largest difference needs. Terrain is smooth, so it's usually 3 bits.
+	*/
+	class PackedTerrainCells
+	{
+	public:
+		PackedTerrainCells() = default;
+		explicit PackedTerrainCells(const TerrainCellsArray& cells);
+
+		TerrainCellsArray Unpack() const;
+
+		// Memory taken by the packed data, including the object itself
+		size_t MemorySize() const;
+
+	private:
+		Rect types_rect;
+		Rect heights_rect;
+
+		std::vector<TerrainType> palette;
+		int bits_per_type = 0;
+		std::vector<uint64_t> type_indices;
+
+		HeightType first_height = 0;
+		int bits_per_height = 0;
+		std::vector<uint64_t> height_deltas;
+	};
+
 	struct TerrainChunk
 	{
 		static constexpr int Size = 32;
@@ -35,12 +72,43 @@ namespace Expanse::Game::Terrain
 		int use_count = 0;
 		TerrainCellsArray cells;
 
+		// set while chunk is idle, cells are empty then
+		std::optional<PackedTerrainCells> packed;
+
 		TerrainChunk() = default;
 
 		explicit TerrainChunk(Point pos)
 			: position(pos)
 			, cells(Area)
 		{}
+
+		bool IsPacked() const { return packed.has_value(); }
+
+		void Pack()
+		{
+			if (!packed) {
+				packed.emplace(cells);
+				cells = {};
+			}
+		}
+
+		void Unpack()
+		{
+			if (packed) {
+				cells = packed->Unpack();
+				packed.reset();
+			}
+		}
+
+		// Cells of packed chunk are unpacked into scratch, so that chunk itself is not changed
+		const TerrainCellsArray& GetCells(TerrainCellsArray& scratch) const
+		{
+			if (!packed)
+				return cells;
+
+			scratch = packed->Unpack();
+			return scratch;
+		}
 	};
 
 	struct AsyncLoadingChunk
@@ -52,11 +120,55 @@ namespace Expanse::Game::Terrain
 
 	namespace Event
 	{
-		struct ChunkLoaded {};
+		// Sent through ecs::Events when chunk data is loaded
+		struct ChunkLoaded
+		{
+			ecs::Entity entity;
+			Point position;
+		};
 	}
+}
 
-	struct ChunkMap
+namespace Expanse
+{
+	template<>
+	struct Serializer<Game::Terrain::TerrainCellsArray>
 	{
-		Array2D<ecs::Entity> chunks;
+		static void Write(BinaryWriter& out, const Game::Terrain::TerrainCellsArray& cells)
+		{
+			out.Write(cells.types);
+			out.Write(cells.heights);
+		}
+
+		static void Read(BinaryReader& in, Game::Terrain::TerrainCellsArray& cells)
+		{
+			in.Read(cells.types);
+			in.Read(cells.heights);
+		}
 	};
+
+	template<>
+	struct Serializer<Game::Terrain::TerrainChunk>
+	{
+		static void Write(BinaryWriter& out, const Game::Terrain::TerrainChunk& chunk)
+		{
+			out.Write(chunk.position);
+			out.Write(chunk.use_count);
+
+			// packed form is only kept in memory
+			Game::Terrain::TerrainCellsArray scratch;
+			out.Write(chunk.GetCells(scratch));
+		}
+
+		static void Read(BinaryReader& in, Game::Terrain::TerrainChunk& chunk)
+		{
+			in.Read(chunk.position);
+			in.Read(chunk.use_count);
+			in.Read(chunk.cells);
+			chunk.packed.reset();
+		}
+	};
+
+	template<>
+	inline constexpr bool ecs::SnapshotComponent<Game::Terrain::TerrainChunk> = true;
 }
\ No newline at end of file
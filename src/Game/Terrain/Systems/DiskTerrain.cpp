@@ -0,0 +1,327 @@
+#include "pch.h"
+
+#include "DiskTerrain.h"
+
+#include "Game/CoordSystems.h"
+
+#include "Utils/Async.h"
+#include "Utils/MappedFile.h"
+
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+
+namespace Expanse::Game::Terrain
+{
+	namespace
+	{
+		struct RegionHeader
+		{
+			static constexpr uint32_t Magic = 0x47525845;	// "EXRG"
+			static constexpr uint32_t Version = 1;
+
+			uint32_t magic = Magic;
+			uint32_t version = Version;
+			uint32_t region_size = TerrainLoader_Disk::RegionSize;
+			uint32_t seed = 0;
+		};
+
+		constexpr size_t ChunksInRegion = TerrainLoader_Disk::RegionSize * TerrainLoader_Disk::RegionSize;
+
+		size_t IndexInRegion(Point pos, Point region_pos)
+		{
+			const auto local = Coords::CellToLocal(pos, region_pos, TerrainLoader_Disk::RegionSize);
+			return static_cast<size_t>(local.y * TerrainLoader_Disk::RegionSize + local.x);
+		}
+
+		// Region files are named "r.<x>.<y>.bin"
+		bool ParseRegionFileName(std::string_view name, Point& region_pos)
+		{
+			const auto* ptr = name.data();
+			const auto* end = name.data() + name.size();
+
+			const auto skip = [&ptr, end](std::string_view str) {
+				if (static_cast<size_t>(end - ptr) < str.size() || std::string_view{ ptr, str.size() } != str)
+					return false;
+				ptr += str.size();
+				return true;
+			};
+			const auto parse = [&ptr, end](int& value) {
+				const auto result = std::from_chars(ptr, end, value);
+				ptr = result.ptr;
+				return result.ec == std::errc{};
+			};
+
+			return skip("r.") && parse(region_pos.x) && skip(".") && parse(region_pos.y) && skip(".bin") && ptr == end;
+		}
+	}
+
+	TerrainLoader_Disk::TerrainLoader_Disk(World& w, std::string dir, uint32_t world_seed)
+		: world(w)
+		, directory(std::move(dir))
+		, seed(world_seed)
+		, fallback(world_seed)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+
+		index_loading = utils::Async(&TerrainLoader_Disk::LoadAllRegions, this);
+
+		unload_observer = world.entities.OnRemove<TerrainChunk>([this](const ecs::ObservedBatch<TerrainChunk>& batch) {
+			SaveChunks(batch);
+		});
+	}
+
+	TerrainLoader_Disk::~TerrainLoader_Disk()
+	{
+		world.entities.RemoveObserver<TerrainChunk>(unload_observer);
+
+		index_loading.wait();
+		for (auto& write : writes) {
+			write.wait();
+		}
+
+		std::unique_lock lock(mutex);
+		loads_done.wait(lock, [this] { return loads_in_flight == 0; });
+	}
+
+	bool TerrainLoader_Disk::HasChunk(Point pos) const
+	{
+		std::scoped_lock lock(mutex);
+		return GetIndexEntry(pos).size > 0;
+	}
+
+	std::future<TerrainCellsArray> TerrainLoader_Disk::LoadChunk(Point pos)
+	{
+		{
+			std::scoped_lock lock(mutex);
+			++loads_in_flight;
+		}
+
+		return utils::Async([this, pos]
+		{
+			auto cells = LoadChunk_Internal(pos);
+
+			// notified under the lock, so that destructor can't finish in between
+			std::scoped_lock lock(mutex);
+			if (--loads_in_flight == 0) {
+				loads_done.notify_all();
+			}
+			return cells;
+		});
+	}
+
+	bool TerrainLoader_Disk::IsIndexLoaded() const
+	{
+		return index_loading.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+	uint32_t TerrainLoader_Disk::LoadOrCreateSeed(const std::string& directory, uint32_t new_seed)
+	{
+		const auto path = directory + "/seed.txt";
+
+		uint32_t seed = 0;
+		if (std::ifstream file{ path }; file >> seed)
+			return seed;
+
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+
+		// seed, which failed to be stored, only costs the cache on the next launch
+		std::ofstream{ path } << new_seed;
+		return new_seed;
+	}
+
+	std::string TerrainLoader_Disk::RegionPath(Point region_pos) const
+	{
+		return directory + "/r." + std::to_string(region_pos.x) + "." + std::to_string(region_pos.y) + ".bin";
+	}
+
+	void TerrainLoader_Disk::LoadRegion(Point region_pos)
+	{
+		{
+			std::scoped_lock lock(mutex);
+			if (regions.contains(region_pos))
+				return;
+		}
+
+		Region region;
+		region.index.resize(ChunksInRegion);
+
+		// only the header and index are read, chunks are read when they are loaded
+		std::ifstream file{ RegionPath(region_pos), std::ios::binary };
+		if (file.is_open())
+		{
+			RegionHeader header;
+			file.read(reinterpret_cast<char*>(&header), sizeof(header));
+			if (file.good() && header.magic == RegionHeader::Magic && header.version == RegionHeader::Version && header.region_size == RegionSize && header.seed == seed)
+			{
+				file.read(reinterpret_cast<char*>(region.index.data()), static_cast<std::streamsize>(region.index.size() * sizeof(IndexEntry)));
+				region.file_valid = file.good();
+			}
+
+			if (!region.file_valid) {
+				std::ranges::fill(region.index, IndexEntry{});
+			}
+		}
+
+		std::scoped_lock lock(mutex);
+		regions.try_emplace(region_pos, std::move(region));
+	}
+
+	void TerrainLoader_Disk::LoadAllRegions()
+	{
+		std::error_code error;
+		for (const auto& file : std::filesystem::directory_iterator(directory, error))
+		{
+			Point region_pos;
+			if (!ParseRegionFileName(file.path().filename().string(), region_pos))
+				continue;
+
+			std::scoped_lock lock(file_mutex);
+			LoadRegion(region_pos);
+		}
+	}
+
+	TerrainLoader_Disk::IndexEntry TerrainLoader_Disk::GetIndexEntry(Point pos) const
+	{
+		const auto region_pos = Coords::CellToChunk(pos, RegionSize);
+		const auto itr = regions.find(region_pos);
+		return (itr != regions.end()) ? itr->second.index[IndexInRegion(pos, region_pos)] : IndexEntry{};
+	}
+
+	void TerrainLoader_Disk::SaveChunks(const ecs::ObservedBatch<TerrainChunk>& batch)
+	{
+		std::vector<PendingChunk> chunks;
+		{
+			std::scoped_lock lock(mutex);
+			batch.ForEach([this, &chunks](auto, const TerrainChunk& chunk)
+			{
+				if (GetIndexEntry(chunk.position).size > 0 || std::ranges::find(pending, chunk.position) != pending.end())
+					return;
+
+				// cells are serialized right away, because component is removed after observers return
+				auto& pending_chunk = chunks.emplace_back(chunk.position);
+				TerrainCellsArray scratch;
+				pending_chunk.data.Write(chunk.GetCells(scratch));
+				pending.push_back(chunk.position);
+			});
+		}
+
+		if (chunks.empty())
+			return;
+
+		std::erase_if(writes, [](const auto& write) { return write.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+		writes.push_back(utils::Async([this, chunks = std::move(chunks)]() mutable { WriteChunks(std::move(chunks)); }));
+	}
+
+	void TerrainLoader_Disk::WriteChunks(std::vector<PendingChunk> chunks)
+	{
+		std::scoped_lock file_lock(file_mutex);
+
+		for (const auto& chunk : chunks)
+		{
+			WriteChunk(chunk);
+
+			std::scoped_lock lock(mutex);
+			std::erase(pending, chunk.pos);
+		}
+	}
+
+	void TerrainLoader_Disk::WriteChunk(const PendingChunk& chunk)
+	{
+		const auto region_pos = Coords::CellToChunk(chunk.pos, RegionSize);
+		const auto entry_index = IndexInRegion(chunk.pos, region_pos);
+		const auto path = RegionPath(region_pos);
+
+		// chunk could be queued before region index was read
+		LoadRegion(region_pos);
+
+		bool file_valid = false;
+		{
+			std::scoped_lock lock(mutex);
+			const auto& region = regions.at(region_pos);
+			if (region.index[entry_index].size > 0)
+				return;
+
+			file_valid = region.file_valid;
+		}
+
+		// file of another world or corrupted one is started anew, index of such region is empty
+		if (!file_valid)
+		{
+			std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+			const RegionHeader header{ .seed = seed };
+			const std::vector<IndexEntry> index(ChunksInRegion);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(IndexEntry)));
+			if (!file.good())
+				return;
+
+			std::scoped_lock lock(mutex);
+			regions.at(region_pos).file_valid = true;
+		}
+
+		std::fstream file{ path, std::ios::binary | std::ios::in | std::ios::out };
+		file.seekp(0, std::ios::end);
+
+		// data is written before the index entry, so that index never points to incomplete data
+		IndexEntry entry;
+		entry.offset = static_cast<uint64_t>(file.tellp());
+		entry.size = static_cast<uint32_t>(chunk.data.Size());
+
+		const auto data = chunk.data.Data();
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+		file.seekp(static_cast<std::streamoff>(sizeof(RegionHeader) + entry_index * sizeof(IndexEntry)));
+		file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+		file.flush();
+
+		// chunk, which failed to be written, is just generated again next time
+		if (file.good())
+		{
+			std::scoped_lock lock(mutex);
+			regions.at(region_pos).index[entry_index] = entry;
+		}
+	}
+
+	TerrainCellsArray TerrainLoader_Disk::LoadChunk_Internal(Point pos)
+	{
+		IndexEntry entry;
+		{
+			std::scoped_lock lock(mutex);
+			entry = GetIndexEntry(pos);
+		}
+
+		TerrainCellsArray cells;
+		if (entry.size > 0 && ReadChunk(pos, entry, cells))
+			return cells;
+
+		// data was damaged outside of the game, so chunk is dropped from the cache and saved again, when unloaded
+		{
+			std::scoped_lock lock(mutex);
+			const auto region_pos = Coords::CellToChunk(pos, RegionSize);
+			if (const auto itr = regions.find(region_pos); itr != regions.end())
+			{
+				auto& current = itr->second.index[IndexInRegion(pos, region_pos)];
+				if (current == entry) {
+					current = IndexEntry{};
+				}
+			}
+		}
+
+		return fallback.GenerateChunk(pos);
+	}
+
+	bool TerrainLoader_Disk::ReadChunk(Point pos, IndexEntry entry, TerrainCellsArray& cells) const
+	{
+		// chunk data is never rewritten in place, so it is read without locks
+		const MappedFile file{ RegionPath(Coords::CellToChunk(pos, RegionSize)), entry.offset, entry.size };
+		if (!file.IsOpen())
+			return false;
+
+		BinaryReader in{ file.Data() };
+		in.Read(cells);
+		return !in.Failed() && cells.types.GetRect() == TerrainChunk::Area && cells.heights.GetRect() == TerrainChunk::AreaVtx;
+	}
+}
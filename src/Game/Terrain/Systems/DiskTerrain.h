@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Game/World.h"
+#include "Game/Terrain/Systems/TerrainLoader.h"
+#include "Game/Terrain/Systems/ProceduralTerrain.h"
+#include "Utils/BinaryStream.h"
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Expanse::Game::Terrain
+{
+	/*
+	* Cache of chunks, which were loaded before, in region files of RegionSize x RegionSize chunks.
+	*
+	* Region file starts with a header: magic, format version, region size, world seed and index of chunks,
+	* i.e. offset and size of every chunk's data, zero size if chunk wasn't saved.
+	* Chunk data follows the header, every saved chunk is appended to the end of the file.
+	* Regions of another seed are ignored and overwritten, so the cache only keeps a single world,
+	* its seed is kept in the same directory, see LoadOrCreateSeed.
+	*
+	* Indices of existing regions are read in the background on construction, HasChunk only looks at
+	* the ones in memory, so it never waits for the disk. Chunks are saved in the background when their
+	* TerrainChunk is removed, chunks, which are already in the cache, are not written again.
+	* Only the chunk's byte range of the region file is mapped to read it.
+	* Chunk, which data turned out to be damaged, is dropped from the index and generated instead.
+	*/
+	class TerrainLoader_Disk : public ITerrainLoader
+	{
+	public:
+		TerrainLoader_Disk(World& world, std::string directory, uint32_t seed);
+		~TerrainLoader_Disk() override;
+
+		bool HasChunk(Point pos) const override;
+
+		std::future<TerrainCellsArray> LoadChunk(Point pos) override;
+
+		// True, once indices of all regions, which existed on construction, are read
+		bool IsIndexLoaded() const;
+
+		// Seed of the world cached in directory, new_seed is stored and returned, if there is none
+		static uint32_t LoadOrCreateSeed(const std::string& directory, uint32_t new_seed);
+
+		static constexpr int RegionSize = 16;
+
+	private:
+		struct IndexEntry
+		{
+			uint64_t offset = 0;
+			uint32_t size = 0;
+			uint32_t reserved = 0;
+
+			bool operator==(const IndexEntry&) const = default;
+		};
+
+		struct Region
+		{
+			std::vector<IndexEntry> index;
+			bool file_valid = false;	// file exists and belongs to this world
+		};
+
+		struct PointLess
+		{
+			bool operator()(Point pt1, Point pt2) const { return (pt1.y != pt2.y) ? (pt1.y < pt2.y) : (pt1.x < pt2.x); }
+		};
+
+		struct PendingChunk
+		{
+			explicit PendingChunk(Point pos_) : pos(pos_) {}
+
+			Point pos;
+			BinaryWriter data;
+		};
+
+		World& world;
+		std::string directory;
+		uint32_t seed = 0;
+		ecs::ObserverId unload_observer = 0;
+
+		// chunks, which turned out to be damaged, are generated instead
+		TerrainLoader_Procedural fallback;
+
+		// guards only the in-memory state below and is never held during file I/O
+		mutable std::mutex mutex;
+		std::map<Point, Region, PointLess> regions;	// region is here once its index is read
+		std::vector<Point> pending;
+		int loads_in_flight = 0;
+		std::condition_variable loads_done;
+
+		// serializes reading of region indices and writing of region files
+		std::mutex file_mutex;
+
+		std::future<void> index_loading;
+		std::vector<std::future<void>> writes;
+
+		std::string RegionPath(Point region) const;
+
+		// Region index is read from its file unless it is already in memory, file_mutex must be locked
+		void LoadRegion(Point region_pos);
+		void LoadAllRegions();
+
+		// Zero entry, if region is not loaded yet, mutex must be locked
+		IndexEntry GetIndexEntry(Point pos) const;
+
+		void SaveChunks(const ecs::ObservedBatch<TerrainChunk>& batch);
+		void WriteChunks(std::vector<PendingChunk> chunks);
+		void WriteChunk(const PendingChunk& chunk);
+
+		TerrainCellsArray LoadChunk_Internal(Point pos);
+		bool ReadChunk(Point pos, IndexEntry entry, TerrainCellsArray& cells) const;
+	};
+}
@@ -19,37 +19,40 @@ namespace Expanse::Game::Terrain
 
 	Render::Mesh GenerateGridMesh(Render::IRenderer* renderer, const TerrainChunk& chunk)
 	{
+		TerrainCellsArray scratch;
+		const auto& heights = chunk.GetCells(scratch).heights;
+
 		// create array with all grid vertices
 		std::vector<Render::VertexP2> vertices;
-		vertices.reserve(chunk.cells.heights.Size());
+		vertices.reserve(heights.Size());
 
-		for (Point cell_pos : utils::rect_points(chunk.cells.heights.GetRect()))
+		for (Point cell_pos : utils::rect_points(heights.GetRect()))
 		{
 			const auto world_pos = FPoint{ cell_pos };
-			const auto height = ToWorldHeight(chunk.cells.heights[cell_pos]);
+			const auto height = ToWorldHeight(heights[cell_pos]);
 			vertices.push_back({ Coords::WorldToScene(world_pos, height) });
 		}
 
 		// create index array
 		std::vector<uint16_t> indices;
-		indices.reserve(chunk.cells.heights.Size() * 2);
+		indices.reserve(heights.Size() * 2);
 
-		auto ToIndex = [w = chunk.cells.heights.Width()](int x, int y){
+		auto ToIndex = [w = heights.Width()](int x, int y){
 			return static_cast<uint16_t>(x + y * w);
 		};
 
-		for (int x = 0; x < chunk.cells.heights.Width(); ++x)
+		for (int x = 0; x < heights.Width(); ++x)
 		{
 			indices.push_back(Render::RestartIndex<uint16_t>);
-			for (int y = 0; y < chunk.cells.heights.Height(); ++y) {
+			for (int y = 0; y < heights.Height(); ++y) {
 				indices.push_back(ToIndex(x, y));
 			}
 		}
 
-		for (int y = 0; y < chunk.cells.heights.Height(); ++y)
+		for (int y = 0; y < heights.Height(); ++y)
 		{
 			indices.push_back(Render::RestartIndex<uint16_t>);
-			for (int x = 0; x < chunk.cells.heights.Width(); ++x) {
+			for (int x = 0; x < heights.Width(); ++x) {
 				indices.push_back(ToIndex(x, y));
 			}
 		}
@@ -62,20 +65,31 @@ namespace Expanse::Game::Terrain
 		: ISystem(w)
 		, renderer(r)
 	{
+		access.MainThread().Structural()
+			.Read<Fields::WorldOrigin, TerrainMesh, TerrainChunk>()
+			.Write<TerrainChunkGrid>();
+
 		material = renderer->CreateMaterial("content/materials/terrain/grid.json");
 	}
 
 	void RenderGrid::UpdateGeometry()
 	{
-		world.entities.ForEach<TerrainMesh, TerrainChunk>([this](auto ent, const TerrainMesh&, const TerrainChunk& chunk)
+		// only chunks, which got their meshes since the last update, may need a grid
+		const auto since = std::exchange(last_tick, world.entities.AdvanceTick());
+
+		std::vector<ecs::Entity> new_chunks;
+		world.entities.ForEach<const TerrainChunk, ecs::Added<TerrainMesh>, ecs::Without<TerrainChunkGrid>>([&new_chunks](auto ent, const TerrainChunk&)
 		{
-			if (!world.entities.HasComponent<TerrainChunkGrid>(ent))
-			{
-				auto* grid_mesh = world.entities.AddComponent<TerrainChunkGrid>(ent);
-				grid_mesh->chunk_pos = chunk.position;
-				grid_mesh->mesh = GenerateGridMesh(renderer, chunk);
-			}
-		});
+			new_chunks.push_back(ent);
+		}, since);
+
+		for (const auto ent : new_chunks)
+		{
+			const auto* chunk = world.entities.GetComponent<const TerrainChunk>(ent);
+			auto* grid_mesh = world.entities.AddComponent<TerrainChunkGrid>(ent);
+			grid_mesh->chunk_pos = chunk->position;
+			grid_mesh->mesh = GenerateGridMesh(renderer, *chunk);
+		}
 	}
 
 	void RenderGrid::Draw()
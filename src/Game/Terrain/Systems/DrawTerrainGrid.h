@@ -2,6 +2,7 @@
 
 #include "Game/ISystem.h"
 #include "Render/IRenderer.h"
+#include "ECS/ComponentStore.h"
 
 namespace Expanse::Game::Terrain
 {
@@ -16,6 +17,8 @@ namespace Expanse::Game::Terrain
 		Render::IRenderer* renderer = nullptr;
 		Render::Material material;
 
+		ecs::ChangeTick last_tick = 0;
+
 		void UpdateGeometry();
 		void Draw();
 	};
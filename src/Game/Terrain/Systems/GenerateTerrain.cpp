@@ -12,30 +12,26 @@
 #include <set>
 
 #include "Game/Terrain/Systems/ProceduralTerrain.h"
+#include "Game/Terrain/Systems/DiskTerrain.h"
 #include "Game/Terrain/TerrainHelpers.h"
 
 namespace Expanse::Game::Terrain
 {
-	namespace
-	{
-		Rect GetMapAreaToLoad(World& world, Point window_size)
-		{
-			const auto window_rect = FRect{ 0, 0, static_cast<float>(window_size.x), static_cast<float>(window_size.y) };
-			const auto view_rect = Centralized(window_rect) / world.camera_scale + world.camera_pos;
-			ScaleFromCenter(view_rect, 2.0f);
-
-			const auto world_rect = Coords::SceneRectWorldBounds(view_rect);
-			const auto cell_rect = Coords::WorldRectCellBounds(world_rect, world.world_origin);
-			const auto chunks_area = Coords::CellRectChunkBounds(cell_rect, TerrainChunk::Size);
-			return chunks_area;
-		}
-	}
-
-	LoadChunks::LoadChunks(World& w, uint32_t seed, Point wnd_size)
+	LoadChunks::LoadChunks(World& w, uint32_t seed, const std::string& cache_dir, Point wnd_size)
 		: ISystem(w)
 		, window_size(wnd_size)
 	{
+		access.Structural()
+			.Read<Fields::Camera, Fields::WorldOrigin>()
+			.Write<ChunkMap, AsyncLoadingChunk, TerrainChunk, Event::ChunkLoaded>();
+
+		// chunks, which were visited before, are read from the cache instead of being generated again
+		AddLoader<TerrainLoader_Disk>(world, cache_dir, seed);
 		AddLoader<TerrainLoader_Procedural>(seed);
+
+		TrackChunkMap(world);
+
+		loaded_events = &world.entities.GetEvents<Event::ChunkLoaded>();
 	}
 
 	ITerrainLoader* LoadChunks::GetLoaderForChunk(Point chunk_pos)
@@ -47,34 +43,11 @@ namespace Expanse::Game::Terrain
 
 	void LoadChunks::Update()
 	{
-		// Clear loaded events
-		const auto ents = world.entities.GetEntitiesWith<Event::ChunkLoaded>();
-		for (auto ent : ents) {
-			world.entities.RemoveComponent<Event::ChunkLoaded>(ent);
-		}
-
-		// Load chunks
+		const auto view_area = GetChunksInView(world, window_size, 1.0f);
 		const auto req_area = GetMapAreaToLoad(world, window_size);
-		if (loaded_area != req_area)
-		{
-			const auto chunks_to_load = GetNotLoadedChunksInArea(world, req_area);
-			for (const auto chunk_pos : chunks_to_load)
-			{
-				// find loader to use
-				if (auto* loader = GetLoaderForChunk(chunk_pos))
-				{
-					auto ent = world.entities.CreateEntity();
-					auto* loading_chunk = world.entities.AddComponent<AsyncLoadingChunk>(ent, chunk_pos);
-					loading_chunk->data = loader->LoadChunk(chunk_pos);
-				}
-			}
-
-			loaded_area = req_area;
-			UpdateChunkMap(world);
-		}
+		const auto mesh_area = GetMeshAreaToLoad(world, window_size);
 
 		// Process loading chunks
-		std::vector<ecs::Entity> loaded_chunks;
 		world.entities.ForEach<AsyncLoadingChunk>([&, this](auto ent, AsyncLoadingChunk& async_chunk)
 		{
 			const auto status = async_chunk.data.wait_for(std::chrono::seconds(0));
@@ -82,14 +55,50 @@ namespace Expanse::Game::Terrain
 			{
 				auto* chunk = world.entities.AddComponent<TerrainChunk>(ent, async_chunk.position);
 				chunk->cells = async_chunk.data.get();
-				
-				world.entities.AddComponent<Event::ChunkLoaded>(ent);
 
-				loaded_chunks.push_back(ent);
+				// chunks, which won't get meshes, stay idle until the view comes to them,
+				// the rest are going to GPU right away and would be unpacked again
+				if (!Contains(mesh_area, chunk->position)) {
+					chunk->Pack();
+				}
+
+				loaded_events->Send({ ent, async_chunk.position });
+
+				commands.RemoveComponent<AsyncLoadingChunk>(ent);
 			}
 		});
-		for (auto ent : loaded_chunks) {
-			world.entities.RemoveComponent<AsyncLoadingChunk>(ent);
+		commands.Playback(world.entities);
+
+		// Queue chunks to load, the ones, which left the area before they were started, are dropped with the old queue
+		if (queued_area != req_area)
+		{
+			load_queue = GetNotLoadedChunksInArea(world, req_area);
+			std::erase_if(load_queue, [this](Point chunk_pos) { return !GetLoaderForChunk(chunk_pos); });
+			queued_area = req_area;
+		}
+
+		if (load_queue.empty())
+			return;
+
+		// View moves within the area, so priorities are recalculated every frame
+		const auto priority = [view_area](Point chunk_pos)
+		{
+			// doubled coordinates, so that centres of chunks and of the view are integer
+			const int dx = 2 * chunk_pos.x + 1 - (2 * view_area.x + view_area.w);
+			const int dy = 2 * chunk_pos.y + 1 - (2 * view_area.y + view_area.h);
+			return std::pair{ Contains(view_area, chunk_pos), -(dx * dx + dy * dy) };
+		};
+		std::ranges::sort(load_queue, std::less{}, priority);
+
+		// Start loading chunks with the highest priority
+		for (auto in_flight = world.entities.GetEntitiesWith<AsyncLoadingChunk>().size(); in_flight < MaxLoadsInFlight && !load_queue.empty(); ++in_flight)
+		{
+			const auto chunk_pos = load_queue.back();
+			load_queue.pop_back();
+
+			auto ent = world.entities.CreateEntity();
+			auto* loading_chunk = world.entities.AddComponent<AsyncLoadingChunk>(ent, chunk_pos);
+			loading_chunk->data = GetLoaderForChunk(chunk_pos)->LoadChunk(chunk_pos);
 		}
 	}
 
@@ -98,24 +107,26 @@ namespace Expanse::Game::Terrain
 	UnloadChunks::UnloadChunks(World& w, Point wnd_size)
 		: ISystem(w)
 		, window_size(wnd_size)
-	{}
+	{
+		access.Structural()
+			.Read<Fields::Camera, Fields::WorldOrigin>()
+			.Write<ChunkMap, TerrainChunk>();
+	}
 
 	void UnloadChunks::Update()
 	{
 		const auto req_area = GetMapAreaToLoad(world, window_size);
 
 		std::vector<ecs::Entity> free_chunks;
-		world.entities.ForEach<TerrainChunk>([req_area, &free_chunks](auto ent, const TerrainChunk& chunk)
+		world.entities.ForEach<const TerrainChunk>([req_area, &free_chunks](auto ent, const TerrainChunk& chunk)
 		{
 			if (chunk.use_count <= 0 && !Contains(req_area, chunk.position)) {
 				free_chunks.push_back(ent);
 			}
 		});
 
-		if (!free_chunks.empty())
-		{
+		if (!free_chunks.empty()) {
 			world.entities.DestroyEntities(free_chunks);
-			UpdateChunkMap(world);
 		}
 	}
 }
\ No newline at end of file
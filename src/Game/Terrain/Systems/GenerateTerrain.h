@@ -4,13 +4,21 @@
 #include "Game/Terrain/Components/TerrainData.h"
 #include "Game/Terrain/Systems/TerrainLoader.h"
 #include "Utils/Math.h"
+#include "ECS/CommandBuffer.h"
 
 namespace Expanse::Game::Terrain
 {
+	/*
+	* Loads chunks around the camera. Missing chunks wait in a queue, which is re-prioritised every frame:
+	* visible chunks go before the ones in the load margin, nearest to the view centre first.
+	* Only a limited number of chunks is loaded at once, so that scrolling doesn't fill the thread pool
+	* with chunks, which are already out of view, and queued chunks, which left the load area, are dropped.
+	*/
 	class LoadChunks : public ISystem
 	{
 	public:
-		LoadChunks(World& w, uint32_t seed, Point window_size);
+		// Visited chunks are cached in cache_dir, which has to belong to the world of the seed
+		LoadChunks(World& w, uint32_t seed, const std::string& cache_dir, Point window_size);
 
 		void Update() override;
 
@@ -19,11 +27,19 @@ namespace Expanse::Game::Terrain
 			loaders.push_back(std::make_unique<T>(std::forward<Args>(args)...));
 		}
 	private:
+		static constexpr size_t MaxLoadsInFlight = 16;
+
 		Point window_size;
-		Rect loaded_area{ 0, 0, 0, 0 };
+
+		// Area, for which the queue was built, and chunks not started yet, highest priority at the back
+		Rect queued_area{ 0, 0, 0, 0 };
+		std::vector<Point> load_queue;
 
 		std::vector<std::unique_ptr<ITerrainLoader>> loaders;
 
+		ecs::CommandBuffer commands;
+		ecs::Events<Event::ChunkLoaded>* loaded_events = nullptr;
+
 		ITerrainLoader* GetLoaderForChunk(Point chunk_pos);
 	};
 
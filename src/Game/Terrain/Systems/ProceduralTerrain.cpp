@@ -23,46 +23,52 @@ namespace Expanse::Game::Terrain
 		GenerateSeeds(type_seeds, types_init_seed);
 	}
 
-	bool TerrainLoader_Procedural::HasChunk(Point pos) const
+	bool TerrainLoader_Procedural::HasChunk(Point) const
 	{
 		return true;
 	}
 
 	std::future<TerrainCellsArray> TerrainLoader_Procedural::LoadChunk(Point chunk_pos)
 	{
-		return utils::Async(&TerrainLoader_Procedural::LoadChunk_Internal, this, chunk_pos);
+		return utils::Async(&TerrainLoader_Procedural::GenerateChunk, this, chunk_pos);
 	}
 
-	TerrainCellsArray TerrainLoader_Procedural::LoadChunk_Internal(Point chunk_pos)
+	TerrainCellsArray TerrainLoader_Procedural::GenerateChunk(Point chunk_pos) const
 	{
 		TerrainCellsArray cells{ TerrainChunk::Area };
 
 		// load terrain types
+		const auto types_rect = Coords::LocalToCell(cells.types.GetRect(), chunk_pos, TerrainChunk::Size);
+
+		std::array<Array2D<float>, 3> type_values;
+		for (size_t i = 0; i < type_values.size(); ++i)
+		{
+			type_values[i] = Array2D<float>{ types_rect };
+			PerlinNoiseFill(type_values[i], 0.07f, type_seeds[i]);
+		}
+
 		for (const auto local_pos : utils::rect_points{ cells.types.GetRect() })
 		{
 			const auto cell_pos = Coords::LocalToCell(local_pos, chunk_pos, TerrainChunk::Size);
-			cells.types[local_pos] = GetTerrainAt(cell_pos);
+			cells.types[local_pos] = GetTerrainType(type_values[0][cell_pos], type_values[1][cell_pos], type_values[2][cell_pos]);
 		}
 
 		// load heightmap
+		Array2D<float> heights{ Coords::LocalToCell(cells.heights.GetRect(), chunk_pos, TerrainChunk::Size) };
+		height_gen.Fill(heights);
+
 		for (const auto local_pos : utils::rect_points{ cells.heights.GetRect() })
 		{
 			const auto cell_pos = Coords::LocalToCell(local_pos, chunk_pos, TerrainChunk::Size);
-			cells.heights[local_pos] = static_cast<HeightType>(height_gen.Get(FPoint{ cell_pos }));
+			cells.heights[local_pos] = static_cast<HeightType>(heights[cell_pos]);
 		}
 
 		return cells;
 	}
 
-	TerrainType TerrainLoader_Procedural::GetTerrainAt(Point cell_pos) const
+	TerrainType TerrainLoader_Procedural::GetTerrainType(float noise0, float noise1, float noise2)
 	{
-		const auto pt = FPoint{ cell_pos } * 0.07f;
-
-		const std::array<float, 3> values = {
-			PerlinNoise(pt, type_seeds[0]),
-			PerlinNoise(pt, type_seeds[1]),
-			PerlinNoise(pt, type_seeds[2]) * 0.7f,
-		};
+		const std::array<float, 3> values = { noise0, noise1, noise2 * 0.7f };
 
 		const auto index = std::distance(std::ranges::begin(values), std::ranges::max_element(values));
 
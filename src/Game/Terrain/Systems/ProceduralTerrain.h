@@ -14,13 +14,15 @@ namespace Expanse::Game::Terrain
 
 		std::future<TerrainCellsArray> LoadChunk(Point pos) override;
 
+		// Generates chunk on the calling thread, for loaders, which fall back to generation
+		TerrainCellsArray GenerateChunk(Point pos) const;
+
 	private:
 		uint32_t type_seeds[3];
 
-		TerrainType GetTerrainAt(Point cell_pos) const;
+		// Type with the highest noise value, noise of each type is sampled at the cell
+		static TerrainType GetTerrainType(float noise0, float noise1, float noise2);
 
 		PerlinNoiseGenerator height_gen;
-
-		TerrainCellsArray LoadChunk_Internal(Point pos);
 	};
 }
\ No newline at end of file
@@ -14,34 +14,45 @@ namespace Expanse::Game::Terrain
 		: ISystem(w)
 		, renderer(r)
 	{
+		// sorting the group swaps components in their stores
+		access.MainThread().Read<Fields::WorldOrigin>().Write<TerrainMesh, TerrainChunk>();
+
+		// group is created here, as creating it is a structural change
+		world.entities.Group<const TerrainMesh, const TerrainChunk>();
 	}
 
 	void RenderChunks::Update()
 	{
-		// Gather all chunks
-		std::vector<std::pair<Point, TerrainMesh>> chunks;
-		world.entities.ForEach<TerrainMesh, TerrainChunk>([&chunks](auto ent, const TerrainMesh& rdata, const TerrainChunk& chunk)
-		{
-			chunks.emplace_back(chunk.position, rdata);
-		});
+		auto chunks = world.entities.Group<const TerrainMesh, const TerrainChunk>();
 
-		// Sort
-		auto comp = [](const auto& ch1, const auto& ch2) { return (ch1.first.x + ch1.first.y) > (ch2.first.x + ch2.first.y); };
-		std::ranges::sort(chunks, comp);
+		// Chunks are sorted in place, only when some entered or left the group, or were changed
+		const auto since = std::exchange(last_tick, world.entities.AdvanceTick());
+		bool changed = (chunks.Generation() != last_generation);
+		if (!changed) {
+			world.entities.ForEach<const TerrainChunk, ecs::Changed<TerrainChunk>>([&changed](auto, const TerrainChunk&) { changed = true; }, since);
+		}
+
+		if (changed)
+		{
+			// mostly they are already in order, so only new ones are moved
+			auto comp = [](const TerrainChunk& ch1, const TerrainChunk& ch2) { return (ch1.position.x + ch1.position.y) > (ch2.position.x + ch2.position.y); };
+			chunks.Sort<TerrainChunk>(comp, ecs::SortMode::Incremental);
+			last_generation = chunks.Generation();
+		}
 
 		// Render
-		for (const auto [pos, data] : chunks)
+		chunks.ForEach([this](auto, const TerrainMesh& data, const TerrainChunk& chunk)
 		{
-			const auto world_pos = Coords::LocalToWorld(FPoint{ 0.0f, 0.0f }, pos, world.world_origin, TerrainChunk::Size);
+			const auto world_pos = Coords::LocalToWorld(FPoint{ 0.0f, 0.0f }, chunk.position, world.world_origin, TerrainChunk::Size);
 			const auto scene_pos = Coords::WorldToScene(world_pos);
 			const auto scene_pos_mat = glm::vec2{ scene_pos.x, scene_pos.y };
 
-			for (const auto [mesh, material] : data.layers)
+			for (const auto& [mesh, material] : data.layers)
 			{
 				renderer->SetMaterialParameter(material, "chunk_pos", scene_pos_mat);
 				renderer->Draw(mesh, material);
 			}
-		}
+		});
 	}
 
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "Game/ISystem.h"
 #include "Render/IRenderer.h"
+#include "ECS/ComponentStore.h"
 
 namespace Expanse::Game::Terrain
 {
@@ -17,5 +18,9 @@ namespace Expanse::Game::Terrain
 
 	private:
 		Render::IRenderer* renderer = nullptr;
+
+		// Group generation and tick of the last sorting
+		uint64_t last_generation = 0;
+		ecs::ChangeTick last_tick = 0;
 	};
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Game/World.h"
 #include "Game/CoordSystems.h"
 #include "Game/Terrain/Components/TerrainMesh.h"
+#include "Game/Terrain/TerrainHelpers.h"
 #include "Utils/Logger/Logger.h"
 #include "Utils/RectPoints.h"
 #include "Game/Utils/NeighbourCells.h"
@@ -17,18 +18,6 @@ namespace Expanse::Game::Terrain
 {
 	namespace
 	{
-		Rect GetChunksAreaToLoad(World& world, Point window_size)
-		{
-			const auto window_rect = FRect{ 0, 0, static_cast<float>(window_size.x), static_cast<float>(window_size.y) };
-			const auto view_rect = Centralized(window_rect) / world.camera_scale + world.camera_pos;
-			ScaleFromCenter(view_rect, 2.0f);
-
-			const auto world_rect = Coords::SceneRectWorldBounds(view_rect);
-			const auto cell_rect = Coords::WorldRectCellBounds(world_rect, world.world_origin);
-			const auto chunks_area = Coords::CellRectChunkBounds(cell_rect, TerrainChunk::Size);
-			return chunks_area;
-		}
-		
 		void FreeTerrainMesh(const TerrainMesh& rdata, Render::IRenderer* renderer)
 		{
 			for (const auto [mesh, material] : rdata.layers)
@@ -48,11 +37,17 @@ namespace Expanse::Game::Terrain
 		: ISystem(w)
 		, renderer(r)
 	{
+		access.MainThread().Structural()
+			.Read<Fields::Camera, Fields::WorldOrigin, ChunkMap, Event::ChunkLoaded>()
+			.Write<TerrainChunk, TerrainMesh, FutureTerrainMesh>();
+
 		static const std::vector<std::string> terrain_mats = {
 			"content/materials/terrain/dirt.json",
 			"content/materials/terrain/grass.json",
 			"content/materials/terrain/stones.json"
 		};
+		loaded_events = &world.entities.GetEvents<Event::ChunkLoaded>();
+
 		for (const auto& mat_desc : terrain_mats)
 		{
 			auto material = renderer->CreateMaterial(mat_desc);
@@ -87,13 +82,13 @@ namespace Expanse::Game::Terrain
 			auto* chunk = world.entities.GetComponent<TerrainChunk>(ent);
 			assert(chunk);
 			chunk->use_count++;
+			chunk->Unpack();
 
 			auto* future_mesh = world.entities.GetOrAddComponent<FutureTerrainMesh>(ent);
 			future_mesh->data = GenerateTerrainMesh(world, chunk->position);
 		};
 
 		// Upload generated meshes
-		std::vector<ecs::Entity> loaded_ents;
 		world.entities.ForEach<FutureTerrainMesh>([&](auto ent, FutureTerrainMesh& future_mesh)
 		{
 			const auto status = future_mesh.data.wait_for(std::chrono::seconds(0));
@@ -103,15 +98,13 @@ namespace Expanse::Game::Terrain
 				auto* mesh = world.entities.GetOrAddComponent<TerrainMesh>(ent);
 				UploadTerrainMeshData(*mesh, data);
 
-				loaded_ents.push_back(ent);
+				commands.RemoveComponent<FutureTerrainMesh>(ent);
 			}
 		});
-		for (auto ent : loaded_ents) {
-			world.entities.RemoveComponent<FutureTerrainMesh>(ent);
-		}
+		commands.Playback(world.entities);
 	}
 
-	std::vector<ecs::Entity> LoadChunksToGPU::GatherChunksToLoad() const
+	std::vector<ecs::Entity> LoadChunksToGPU::GatherChunksToLoad()
 	{
 		std::vector<ecs::Entity> gen_entities;
 
@@ -119,27 +112,35 @@ namespace Expanse::Game::Terrain
 		if (!map)
 			return gen_entities;
 
-		const auto visible_area = GetChunksAreaToLoad(world, renderer->GetWindowSize());
-		const auto load_area = Intersection(map->chunks.GetRect(), visible_area);
-
+		const auto load_area = GetMeshAreaToLoad(world, renderer->GetWindowSize());
 		if (load_area.w <= 0 || load_area.h <= 0)
 			return gen_entities;
 
+		// nothing was loaded or unloaded and view didn't move, so there are no new chunks to pick up
+		if (load_area == last_load_area && map->Generation() == last_map_generation && !loaded_events->HasUnread(loaded_reader))
+			return gen_entities;
+		last_map_generation = map->Generation();
+
+		// chunks, which were already in load area, were picked up before, so only new ones are checked
+		const auto since = std::exchange(last_tick, world.entities.AdvanceTick());
+		const auto prev_load_area = std::exchange(last_load_area, load_area);
+		const auto new_since = (load_area == prev_load_area) ? since : ecs::ChangeTick{ 0 };
+
 		Array2D<bool> load_map{ load_area, false };
 
 		// gather not loaded chunks in view
-		world.entities.ForEach<TerrainChunk>([this, &load_map](auto ent, const TerrainChunk& chunk)
+		world.entities.ForEach<const TerrainChunk, ecs::Added<TerrainChunk>, ecs::Without<TerrainMesh, FutureTerrainMesh>>([&load_map](auto ent, const TerrainChunk& chunk)
 		{
-			if (!world.entities.HasAnyComponent<TerrainMesh, FutureTerrainMesh>(ent) && load_map.IndexIsValid(chunk.position)) {
+			if (load_map.IndexIsValid(chunk.position)) {
 				load_map[chunk.position] = true;
 			}
-		});
+		}, new_since);
 
 		// gather chunks to update (update these one even if async operation is already running)
-		world.entities.ForEach<Event::ChunkLoaded, TerrainChunk>([&load_map](auto ent, const Event::ChunkLoaded&, const TerrainChunk& chunk)
+		loaded_events->Read(loaded_reader, [&load_map](const Event::ChunkLoaded& event)
 		{
 			for (Point off : Offset::Neighbors8) {
-				const Point pos = chunk.position + off;
+				const Point pos = event.position + off;
 				if (load_map.IndexIsValid(pos)) {
 					load_map[pos] = true;
 				}
@@ -149,7 +150,7 @@ namespace Expanse::Game::Terrain
 		// convert chunk map to entities list
 		for (Point pt : utils::rect_points(load_map.GetRect()))
 		{
-			const auto ent = map->chunks[pt];
+			const auto ent = map->Find(pt);
 			if (load_map[pt] && ent && world.entities.HasComponent<TerrainChunk>(ent)) {
 				gen_entities.push_back(ent);
 			}
@@ -164,27 +165,31 @@ namespace Expanse::Game::Terrain
 		: ISystem(w)
 		, renderer(r)
 	{
+		access.MainThread().Structural()
+			.Read<Fields::Camera, Fields::WorldOrigin>()
+			.Write<TerrainChunk, TerrainMesh>();
+
+		world.entities.Group<const TerrainMesh, const TerrainChunk>();
 	}
 
 	void UnloadChunksFromGPU::Update()
 	{
-		const auto visible_area = GetChunksAreaToLoad(world, renderer->GetWindowSize());
+		const auto visible_area = GetMeshAreaToLoad(world, renderer->GetWindowSize());
 
-		std::vector<ecs::Entity> freed_chunks;
-		world.entities.ForEach<TerrainMesh, TerrainChunk>([this, &freed_chunks, visible_area](auto ent, const TerrainMesh& rdata, TerrainChunk& chunk)
+		world.entities.Group<const TerrainMesh, const TerrainChunk>().ForEach([this, visible_area](auto ent, const TerrainMesh& rdata, const TerrainChunk& chunk)
 		{
 			if (!Contains(visible_area, chunk.position))
 			{
 				FreeTerrainMesh(rdata, renderer);
 
-				freed_chunks.push_back(ent);
+				// only freed chunks are written, so the rest don't look changed
+				auto* idle_chunk = world.entities.GetComponent<TerrainChunk>(ent);
+				idle_chunk->use_count--;
+				idle_chunk->Pack();
 
-				chunk.use_count--;
+				commands.RemoveComponent<TerrainMesh>(ent);
 			}
 		});
-
-		for (auto ent : freed_chunks) {
-			world.entities.RemoveComponent<TerrainMesh>(ent);
-		}
+		commands.Playback(world.entities);
 	}
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "Game/ISystem.h"
 #include "Render/IRenderer.h"
+#include "ECS/CommandBuffer.h"
 #include "Game/Terrain/Components/TerrainData.h"
 #include "Game/Terrain/Components/TerrainMesh.h"
 #include "TerrainMeshGenerator.h"
@@ -24,7 +25,17 @@ namespace Expanse::Game::Terrain
 
 		void UploadTerrainMeshData(TerrainMesh& rdata, const TerrainMeshData& data);
 
-		std::vector<ecs::Entity> GatherChunksToLoad() const;
+		ecs::CommandBuffer commands;
+
+		const ecs::Events<Event::ChunkLoaded>* loaded_events = nullptr;
+		ecs::Events<Event::ChunkLoaded>::Reader loaded_reader;
+
+		// Area and tick of the last gathering, chunks are only rescanned when area changes
+		Rect last_load_area;
+		ecs::ChangeTick last_tick = 0;
+		uint64_t last_map_generation = 0;
+
+		std::vector<ecs::Entity> GatherChunksToLoad();
 	};
 
 	/*
@@ -39,5 +50,7 @@ namespace Expanse::Game::Terrain
 
 	private:
 		Render::IRenderer* renderer = nullptr;
+
+		ecs::CommandBuffer commands;
 	};
 }
\ No newline at end of file
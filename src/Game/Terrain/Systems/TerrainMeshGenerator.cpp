@@ -268,16 +268,20 @@ namespace Expanse::Game::Terrain
 		TerrainCellsArray cells{ Inflated(TerrainChunk::Area, 1, 1) };
 
 		auto* map = world.globals.Get<ChunkMap>();
-		if (!map || !map->chunks.IndexIsValid(chunk_pos))
+		if (!map)
 			return cells;
 
+		// neighbours out of view are packed, they are unpacked here without being changed
+		TerrainCellsArray scratch;
+
 		// Fill central part
-		const auto chunk_ent = map->chunks[chunk_pos];
+		const auto chunk_ent = map->Find(chunk_pos);
 		if (chunk_ent)
 		{
-			if (auto* chunk = world.entities.GetComponent<TerrainChunk>(chunk_ent)) {
-				CopyArrayData(chunk->cells.types, cells.types, TerrainChunk::Area, LeftBottom(TerrainChunk::Area));
-				CopyArrayData(chunk->cells.heights, cells.heights, TerrainChunk::AreaVtx, LeftBottom(TerrainChunk::AreaVtx));
+			if (const auto* chunk = world.entities.GetComponent<const TerrainChunk>(chunk_ent)) {
+				const auto& chunk_cells = chunk->GetCells(scratch);
+				CopyArrayData(chunk_cells.types, cells.types, TerrainChunk::Area, LeftBottom(TerrainChunk::Area));
+				CopyArrayData(chunk_cells.heights, cells.heights, TerrainChunk::AreaVtx, LeftBottom(TerrainChunk::AreaVtx));
 			}
 		}
 
@@ -293,12 +297,13 @@ namespace Expanse::Game::Terrain
 			const auto dst_area_vtx = Intersection(cells.heights.GetRect(), TerrainChunk::AreaVtx + offset * TerrainChunk::Size);
 			const auto src_area_vtx = dst_area_vtx - offset * TerrainChunk::Size;
 
-			const auto nchunk_ent = map->chunks.GetOrDef(nchunk_pos, ecs::Entity{});
+			const auto nchunk_ent = map->Find(nchunk_pos);
 			if (nchunk_ent)
 			{
-				if (auto* chunk = world.entities.GetComponent<TerrainChunk>(nchunk_ent)) {
-					CopyArrayData(chunk->cells.types, cells.types, src_area_cells, LeftBottom(dst_area_cells));
-					CopyArrayData(chunk->cells.heights, cells.heights, src_area_vtx, LeftBottom(dst_area_vtx));
+				if (const auto* chunk = world.entities.GetComponent<const TerrainChunk>(nchunk_ent)) {
+					const auto& chunk_cells = chunk->GetCells(scratch);
+					CopyArrayData(chunk_cells.types, cells.types, src_area_cells, LeftBottom(dst_area_cells));
+					CopyArrayData(chunk_cells.heights, cells.heights, src_area_vtx, LeftBottom(dst_area_vtx));
 				}
 			}
 		}
@@ -3,38 +3,57 @@
 #include "TerrainHelpers.h"
 
 #include "Components/TerrainData.h"
-#include "Utils/Bounds.h"
+#include "Game/CoordSystems.h"
 #include "Utils/RectPoints.h"
 
 namespace Expanse::Game::Terrain
 {
-	void UpdateChunkMap(World& world)
+	namespace
 	{
-		auto* map = world.globals.GetOrCreate<ChunkMap>();
-		
-		// Calculate bounding rect of all chunks
-		utils::Bounds<int> bounds;
-		for (const auto& chunk : world.entities.GetComponentArray<TerrainChunk>()) {
-			bounds.Add(chunk.position);
-		}
-		for (const auto& chunk : world.entities.GetComponentArray<AsyncLoadingChunk>()) {
-			bounds.Add(chunk.position);
-		}
-		const auto bounds_rect = bounds.ToRect();
-
-		// Write entities into map
-		if (bounds_rect.w > 0 && bounds_rect.h > 0)
+		// Chunk is in the map while its entity has any of Comps
+		template<typename Comp, typename... Other>
+		void TrackChunkComponent(World& world)
 		{
-			map->chunks = Array2D<ecs::Entity>(bounds_rect);
-			world.entities.ForEach<TerrainChunk>([map](auto entity, const TerrainChunk& chunk){
-				map->chunks[chunk.position] = entity;
+			world.entities.OnAdd<Comp>([&world](const ecs::ObservedBatch<Comp>& batch)
+			{
+				if (auto* map = world.globals.Get<ChunkMap>())
+				{
+					batch.ForEach([map](auto entity, const Comp& chunk) {
+						map->Insert(chunk.position, entity);
+					});
+				}
 			});
-			world.entities.ForEach<AsyncLoadingChunk>([map](auto entity, const AsyncLoadingChunk& chunk) {
-				map->chunks[chunk.position] = entity;
+
+			world.entities.OnRemove<Comp>([&world](const ecs::ObservedBatch<Comp>& batch)
+			{
+				if (auto* map = world.globals.Get<ChunkMap>())
+				{
+					batch.ForEach([&world, map](auto entity, const Comp& chunk) {
+						if (!world.entities.HasAnyComponent<Other...>(entity)) {
+							map->Erase(chunk.position, entity);
+						}
+					});
+				}
 			});
 		}
 	}
 
+	void TrackChunkMap(World& world)
+	{
+		if (world.globals.Get<ChunkMap>()) return;
+
+		auto* map = world.globals.Set<ChunkMap>();
+		world.entities.ForEach<const TerrainChunk>([map](auto entity, const TerrainChunk& chunk) {
+			map->Insert(chunk.position, entity);
+		});
+		world.entities.ForEach<const AsyncLoadingChunk>([map](auto entity, const AsyncLoadingChunk& chunk) {
+			map->Insert(chunk.position, entity);
+		});
+
+		TrackChunkComponent<TerrainChunk, AsyncLoadingChunk>(world);
+		TrackChunkComponent<AsyncLoadingChunk, TerrainChunk>(world);
+	}
+
 	std::vector<Point> GetNotLoadedChunksInArea(World& world, Rect chunks_area)
 	{
 		std::vector<Point> result;
@@ -42,11 +61,31 @@ namespace Expanse::Game::Terrain
 
 		for (Point pt : utils::rect_points(chunks_area))
 		{
-			if (!map || !map->chunks.IndexIsValid(pt) || !map->chunks[pt]) {
+			if (!map || !map->Find(pt)) {
 				result.push_back(pt);
 			}
 		}
 
 		return result;
 	}
+
+	Rect GetChunksInView(World& world, Point window_size, float scale)
+	{
+		const auto window_rect = FRect{ 0, 0, static_cast<float>(window_size.x), static_cast<float>(window_size.y) };
+		const auto view_rect = ScaledFromCenter(Centralized(window_rect) / world.camera_scale + world.camera_pos, scale);
+
+		const auto world_rect = Coords::SceneRectWorldBounds(view_rect);
+		const auto cell_rect = Coords::WorldRectCellBounds(world_rect, world.world_origin);
+		return Coords::CellRectChunkBounds(cell_rect, TerrainChunk::Size);
+	}
+
+	Rect GetMapAreaToLoad(World& world, Point window_size)
+	{
+		return GetChunksInView(world, window_size, 3.0f);
+	}
+
+	Rect GetMeshAreaToLoad(World& world, Point window_size)
+	{
+		return GetChunksInView(world, window_size, 2.0f);
+	}
 }
\ No newline at end of file
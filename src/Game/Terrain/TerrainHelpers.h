@@ -4,7 +4,22 @@
 
 namespace Expanse::Game::Terrain
 {
-	void UpdateChunkMap(World& world);
+	/*
+	* Creates ChunkMap and keeps it in sync with TerrainChunk and AsyncLoadingChunk components,
+	* so that loading and unloading only touches map cells of the changed chunks.
+	* Does nothing if the map is already tracked.
+	*/
+	void TrackChunkMap(World& world);
 
 	std::vector<Point> GetNotLoadedChunksInArea(World& world, Rect chunks_area);
+
+	// Chunks covered by the view, scaled from its centre
+	Rect GetChunksInView(World& world, Point window_size, float scale);
+
+	// Chunks around the view are kept loaded, so that scrolling doesn't show missing ones.
+	// It is wider than the mesh area, chunks between the two stay packed until they get meshes
+	Rect GetMapAreaToLoad(World& world, Point window_size);
+
+	// Chunks, which have meshes on GPU, always inside the loaded area
+	Rect GetMeshAreaToLoad(World& world, Point window_size);
 }
\ No newline at end of file
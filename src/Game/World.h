@@ -21,4 +21,11 @@ namespace Expanse::Game
         // Frame delta time
         float dt = 0.0f;
     };
+
+    // Tags for declaring access to World fields in SystemAccess
+    namespace Fields
+    {
+        struct Camera {}; // camera_pos, camera_scale
+        struct WorldOrigin {}; // world_origin
+    }
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Utils/Math.h"
+#include "Utils/BinaryStream.h"
 
 #include <memory>
 #include <cassert>
@@ -139,4 +140,43 @@ namespace Expanse
 			dst_line += dst_row_size;
 		}
 	}
+
+	template<class Elem>
+	struct Serializer<Array2D<Elem>>
+	{
+		static void Write(BinaryWriter& out, const Array2D<Elem>& arr)
+		{
+			out.Write(arr.GetRect());
+			if constexpr (std::is_trivially_copyable_v<Elem> && !HasSerializer<Elem>) {
+				out.WriteBytes(arr.begin(), arr.Size() * sizeof(Elem));
+			} else {
+				for (const auto& elem : arr) out.Write(elem);
+			}
+		}
+
+		static void Read(BinaryReader& in, Array2D<Elem>& arr)
+		{
+			const auto rect = in.Read<Rect>();
+			if (rect.w <= 0 || rect.h <= 0)
+			{
+				arr = Array2D<Elem>{};
+				return;
+			}
+
+			if constexpr (std::is_trivially_copyable_v<Elem> && !HasSerializer<Elem>)
+			{
+				// size is checked before allocating, rect may come from corrupted data
+				const auto* data = in.Skip(static_cast<size_t>(rect.w) * static_cast<size_t>(rect.h) * sizeof(Elem));
+				if (!data) return;
+
+				arr = Array2D<Elem>(rect);
+				std::memcpy(arr.begin(), data, arr.Size() * sizeof(Elem));
+			}
+			else
+			{
+				arr = Array2D<Elem>(rect);
+				for (auto& elem : arr) in.Read(elem);
+			}
+		}
+	};
 }
\ No newline at end of file
@@ -66,4 +66,45 @@ namespace Expanse::utils
 	{
 		thread_pool.Run(func);
 	}
+
+	void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& func)
+	{
+		if (count == 0) return;
+
+		grain = std::max<size_t>(grain, 1);
+		const size_t ranges_count = (count + grain - 1) / grain;
+
+		struct Context
+		{
+			std::atomic<size_t> next_range = 0;
+			std::atomic<size_t> done_ranges = 0;
+		};
+		auto ctx = std::make_shared<Context>();
+
+		// helpers, that start after all ranges were taken, exit without touching func
+		auto process_ranges = [ctx, ranges_count, count, grain, &func]
+		{
+			for (size_t range = ctx->next_range++; range < ranges_count; range = ctx->next_range++)
+			{
+				const auto begin = range * grain;
+				func(begin, std::min(count, begin + grain));
+
+				if (++ctx->done_ranges == ranges_count) {
+					ctx->done_ranges.notify_all();
+				}
+			}
+		};
+
+		const auto helpers_count = std::min(ranges_count - 1, thread_pool.ThreadCount());
+		for (size_t i = 0; i < helpers_count; ++i) {
+			thread_pool.Run(process_ranges);
+		}
+
+		process_ranges();
+
+		// pool threads might be busy with other tasks, so wait for ranges, not for helpers
+		for (auto done = ctx->done_ranges.load(); done != ranges_count; done = ctx->done_ranges.load()) {
+			ctx->done_ranges.wait(done);
+		}
+	}
 }
\ No newline at end of file
@@ -12,6 +12,8 @@ namespace Expanse::utils
 		~ThreadPool();
 
 		void Run(std::function<void()> task);
+
+		size_t ThreadCount() const { return threads.size(); }
 	private:
 		void WorkerThread();
 		std::function<void()> PopTask();
@@ -27,6 +29,12 @@ namespace Expanse::utils
 
 	void AsyncVoid(std::function<void()> func);
 
+	/*
+	* Splits [0, count) into ranges of grain elements and calls func(begin, end) for each of them
+	* on the shared thread pool. Calling thread processes ranges too and returns when all are done.
+	*/
+	void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& func);
+
 	template<typename Func, typename... Args>
 	[[nodiscard]] auto Async(Func&& func, Args&&... args)
 	{
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <cassert>
+
+namespace Expanse
+{
+	class BinaryWriter;
+	class BinaryReader;
+
+	/*
+	* Binary serialization of types, which are not trivially copyable, or need custom layout:
+	*
+	*	template<> struct Serializer<Foo> {
+	*		static void Write(BinaryWriter& out, const Foo& value);
+	*		static void Read(BinaryReader& in, Foo& value);
+	*	};
+	*
+	* Trivially copyable types without a serializer are copied as raw bytes.
+	*/
+	template<typename T>
+	struct Serializer;
+
+	template<typename T>
+	concept HasSerializer = requires(BinaryWriter& out, BinaryReader& in, const T& cvalue, T& value)
+	{
+		Serializer<T>::Write(out, cvalue);
+		Serializer<T>::Read(in, value);
+	};
+
+	template<typename T>
+	concept BinarySerializable = HasSerializer<T> || std::is_trivially_copyable_v<T>;
+
+	/* Appends values to a growing memory buffer */
+	class BinaryWriter
+	{
+	public:
+		void WriteBytes(const void* data, size_t size)
+		{
+			const auto* bytes = static_cast<const std::byte*>(data);
+			buffer.insert(buffer.end(), bytes, bytes + size);
+		}
+
+		template<BinarySerializable T>
+		void Write(const T& value)
+		{
+			if constexpr (HasSerializer<T>) {
+				Serializer<T>::Write(*this, value);
+			} else {
+				WriteBytes(&value, sizeof(T));
+			}
+		}
+
+		// Overwrites trivially copyable value written earlier, e.g. size of a block, which wasn't known upfront
+		template<typename T>
+		void WriteAt(size_t offset, const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			assert(offset + sizeof(T) <= buffer.size());
+			std::memcpy(buffer.data() + offset, &value, sizeof(T));
+		}
+
+		void Reserve(size_t capacity) { buffer.reserve(capacity); }
+
+		size_t Size() const noexcept { return buffer.size(); }
+		std::span<const std::byte> Data() const noexcept { return buffer; }
+
+	private:
+		std::vector<std::byte> buffer;
+	};
+
+	/*
+	* Reads values from a memory block, which it doesn't own.
+	* Reading past the end doesn't throw: reader goes into failed state and returns zeroes,
+	* so that corrupted data can be detected once after reading.
+	*/
+	class BinaryReader
+	{
+	public:
+		explicit BinaryReader(std::span<const std::byte> data_)
+			: data(data_)
+		{}
+
+		void ReadBytes(void* dst, size_t size)
+		{
+			if (const auto* src = Skip(size)) {
+				std::memcpy(dst, src, size);
+			} else {
+				std::memset(dst, 0, size);
+			}
+		}
+
+		template<BinarySerializable T>
+		void Read(T& value)
+		{
+			if constexpr (HasSerializer<T>) {
+				Serializer<T>::Read(*this, value);
+			} else {
+				ReadBytes(&value, sizeof(T));
+			}
+		}
+
+		template<BinarySerializable T>
+		T Read()
+		{
+			T value{};
+			Read(value);
+			return value;
+		}
+
+		// Returns pointer to the next size bytes and moves past them, nullptr if there are not enough bytes
+		const std::byte* Skip(size_t size)
+		{
+			if (failed || size > Remaining())
+			{
+				failed = true;
+				return nullptr;
+			}
+
+			const auto* ptr = data.data() + position;
+			position += size;
+			return ptr;
+		}
+
+		size_t Remaining() const noexcept { return data.size() - position; }
+		bool Failed() const noexcept { return failed; }
+
+	private:
+		std::span<const std::byte> data;
+		size_t position = 0;
+		bool failed = false;
+	};
+}
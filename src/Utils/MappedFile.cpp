@@ -0,0 +1,125 @@
+#include "Utils/MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Expanse
+{
+	MappedFile::MappedFile(const std::string& path)
+	{
+		Map(path, 0, 0);
+	}
+
+	MappedFile::MappedFile(const std::string& path, uint64_t offset, size_t length)
+	{
+		if (length > 0) {
+			Map(path, offset, length);
+		}
+	}
+
+	void MappedFile::Map(const std::string& path, uint64_t offset, size_t length)
+	{
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return;
+
+		LARGE_INTEGER file_size{};
+		const bool whole = (length == 0);
+		if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0 && (whole || offset + length <= static_cast<uint64_t>(file_size.QuadPart)))
+		{
+			SYSTEM_INFO info{};
+			GetSystemInfo(&info);
+			const uint64_t view_offset = offset - offset % info.dwAllocationGranularity;
+			const size_t mapped_size = whole ? static_cast<size_t>(file_size.QuadPart) : static_cast<size_t>(offset - view_offset) + length;
+
+			// view keeps the mapping alive, so both handles can be closed right away
+			HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping)
+			{
+				if (void* ptr = MapViewOfFile(mapping, FILE_MAP_READ, static_cast<DWORD>(view_offset >> 32), static_cast<DWORD>(view_offset), mapped_size))
+				{
+					view = static_cast<const std::byte*>(ptr);
+					view_size = mapped_size;
+				}
+				CloseHandle(mapping);
+			}
+		}
+		CloseHandle(file);
+#else
+		const int file = open(path.c_str(), O_RDONLY);
+		if (file < 0) return;
+
+		struct stat file_stat{};
+		const bool whole = (length == 0);
+		if (fstat(file, &file_stat) == 0 && file_stat.st_size > 0 && (whole || offset + length <= static_cast<uint64_t>(file_stat.st_size)))
+		{
+			const auto page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+			const uint64_t view_offset = offset - offset % page_size;
+			const size_t mapped_size = whole ? static_cast<size_t>(file_stat.st_size) : static_cast<size_t>(offset - view_offset) + length;
+
+			void* ptr = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, file, static_cast<off_t>(view_offset));
+			if (ptr != MAP_FAILED)
+			{
+				view = static_cast<const std::byte*>(ptr);
+				view_size = mapped_size;
+			}
+		}
+		close(file);
+#endif
+		if (view)
+		{
+			data = view + (view_size - (whole ? view_size : length));
+			size = whole ? view_size : length;
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+		: data(std::exchange(other.data, nullptr))
+		, size(std::exchange(other.size, 0))
+		, view(std::exchange(other.view, nullptr))
+		, view_size(std::exchange(other.view_size, 0))
+	{}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+			data = std::exchange(other.data, nullptr);
+			size = std::exchange(other.size, 0);
+			view = std::exchange(other.view, nullptr);
+			view_size = std::exchange(other.view_size, 0);
+		}
+		return *this;
+	}
+
+	void MappedFile::Close() noexcept
+	{
+		if (!view) return;
+
+#ifdef _WIN32
+		UnmapViewOfFile(view);
+#else
+		munmap(const_cast<std::byte*>(view), view_size);
+#endif
+		data = nullptr;
+		size = 0;
+		view = nullptr;
+		view_size = 0;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+
+namespace Expanse
+{
+	/*
+	* Read-only memory mapping of a whole file or of its part, pages are loaded by the OS on first access.
+	* Data stays valid until the object is destroyed. File may be written by others while it is mapped.
+	*/
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const std::string& path);
+		// Maps only [offset, offset + length), fails if the range goes past the end of file
+		MappedFile(const std::string& path, uint64_t offset, size_t length);
+		~MappedFile();
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// False if file doesn't exist or couldn't be mapped, empty files are not mapped either
+		bool IsOpen() const noexcept { return data != nullptr; }
+
+		std::span<const std::byte> Data() const noexcept { return { data, size }; }
+
+	private:
+		const std::byte* data = nullptr;
+		size_t size = 0;
+
+		// mapped view starts at the allocation boundary before data
+		const std::byte* view = nullptr;
+		size_t view_size = 0;
+
+		// Maps the whole file if length is zero
+		void Map(const std::string& path, uint64_t offset, size_t length);
+		void Close() noexcept;
+	};
+}
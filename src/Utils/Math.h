@@ -183,14 +183,14 @@ namespace Expanse
 		return rect;
 	}
 
-	constexpr void ScaleFromCenter(FRect rect, FPoint scale)
+	constexpr void ScaleFromCenter(FRect& rect, FPoint scale)
 	{
 		const auto dx = rect.w * (scale.x - 1.0f) * 0.5f;
 		const auto dy = rect.h * (scale.y - 1.0f) * 0.5f;
 		Inflate(rect, dx, dy);
 	}
 
-	constexpr void ScaleFromCenter(FRect rect, float scale)
+	constexpr void ScaleFromCenter(FRect& rect, float scale)
 	{
 		scale = (scale - 1.0f) * 0.5f;
 		Inflate(rect, rect.w * scale, rect.h * scale);
@@ -1,8 +1,123 @@
 #include "Utils/PerlinNoiseGenerator.h"
 #include "Utils/Utils.h"
 
+#include <array>
+#include <numbers>
+
 namespace Expanse
 {
+	namespace
+	{
+		/*
+		* PerlinNoise takes gradient angle from the low 23 bits of the hash,
+		* table is indexed by the high bits of them and keeps directions at the centres of its sectors.
+		*/
+		constexpr int GradientBits = 10;
+
+		const std::array<FPoint, 1 << GradientBits>& GetGradientTable()
+		{
+			static const auto table = [] {
+				std::array<FPoint, 1 << GradientBits> result;
+				for (size_t i = 0; i < result.size(); ++i)
+				{
+					const auto angle = 2.0f * std::numbers::pi_v<float> * (static_cast<float>(i) + 0.5f) / static_cast<float>(result.size());
+					result[i] = FPoint{ std::sin(angle), std::cos(angle) };
+				}
+				return result;
+			}();
+			return table;
+		}
+
+		/*
+		* Calls store(value, dst) for every point of values with the noise value and its element.
+		*
+		* Interpolating dot products along y first, contribution of lattice column c to a row is tx * P[c] + Q[c],
+		* where tx is the offset from the column. P and Q are computed once per row and lattice column,
+		* so per point it is two multiply-adds and lerps, without hashing or branches.
+		*/
+		template<typename Store>
+		void PerlinNoiseRows(Array2D<float>& values, float freq, uint32_t seed, Store store)
+		{
+			if (values.Empty()) return;
+
+			auto ease = [](float t) {
+				return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+			};
+
+			const auto rect = values.GetRect();
+			const auto width = static_cast<size_t>(rect.w);
+
+			// lattice columns and offsets of points in a row are the same for all rows
+			std::vector<int> cols(width);
+			std::vector<float> txs(width);
+			std::vector<float> sxs(width);
+			for (size_t i = 0; i < width; ++i)
+			{
+				const auto px = static_cast<float>(rect.x + static_cast<int>(i)) * freq;
+				const auto fx = std::floor(px);
+				cols[i] = static_cast<int>(fx);
+				txs[i] = px - fx;
+				sxs[i] = ease(px - fx);
+			}
+
+			const auto lattice_x = cols.front();
+			const auto lattice_y = static_cast<int>(std::floor(static_cast<float>(rect.y) * freq));
+			const auto lattice_w = static_cast<size_t>(cols.back() - lattice_x + 2);
+			const auto lattice_h = static_cast<size_t>(static_cast<int>(std::floor(static_cast<float>(rect.y + rect.h - 1) * freq)) - lattice_y + 2);
+
+			// gradients of all lattice points around the rect
+			const auto& table = GetGradientTable();
+			std::vector<FPoint> grads(lattice_w * lattice_h);
+			for (size_t j = 0; j < lattice_h; ++j)
+			{
+				for (size_t i = 0; i < lattice_w; ++i)
+				{
+					const auto noise = Squirrel3(Point{ lattice_x + static_cast<int>(i), lattice_y + static_cast<int>(j) }, seed);
+					grads[j * lattice_w + i] = table[(noise & 0x007FFFFF) >> (23 - GradientBits)];
+				}
+			}
+
+			for (auto& col : cols) {
+				col -= lattice_x;
+			}
+
+			std::vector<float> ps(lattice_w);
+			std::vector<float> qs(lattice_w);
+
+			for (int y = rect.y; y < rect.y + rect.h; ++y)
+			{
+				const auto py = static_cast<float>(y) * freq;
+				const auto fy = std::floor(py);
+				const auto ty = py - fy;
+				const auto sy = ease(ty);
+
+				const auto* grads0 = &grads[static_cast<size_t>(static_cast<int>(fy) - lattice_y) * lattice_w];
+				const auto* grads1 = grads0 + lattice_w;
+				for (size_t c = 0; c < lattice_w; ++c)
+				{
+					ps[c] = Lerp(grads0[c].x, grads1[c].x, sy);
+					qs[c] = Lerp(grads0[c].y * ty, grads1[c].y * (ty - 1.0f), sy);
+				}
+
+				auto* row = &values[Point{ rect.x, y }];
+				for (size_t i = 0; i < width; ++i)
+				{
+					const auto c = static_cast<size_t>(cols[i]);
+					const auto v0 = txs[i] * ps[c] + qs[c];
+					const auto v1 = (txs[i] - 1.0f) * ps[c + 1] + qs[c + 1];
+					const auto v = Lerp(v0, v1, sxs[i]);
+
+					store(std::clamp((v + 0.55f) / 1.1f, 0.0f, 1.0f), row[i]);
+				}
+			}
+		}
+	}
+
+	void PerlinNoiseFill(Array2D<float>& values, float freq, uint32_t seed)
+	{
+		PerlinNoiseRows(values, freq, seed, [](float noise, float& dst) { dst = noise; });
+	}
+
 	float PerlinNoiseGenerator::Get(FPoint pos) const
 	{
 		float value = 0.0f;
@@ -12,4 +127,13 @@ namespace Expanse
 		});
 		return value;
 	}
-}
\ No newline at end of file
+
+	void PerlinNoiseGenerator::Fill(Array2D<float>& values) const
+	{
+		std::fill(values.begin(), values.end(), 0.0f);
+		utils::for_each_zipped(seeds, harmonics, [&values](uint32_t seed, const auto& h)
+		{
+			PerlinNoiseRows(values, h.freq, seed, [&h](float noise, float& dst) { dst += Lerp(h.min, h.max, noise); });
+		});
+	}
+}
@@ -2,6 +2,7 @@
 
 #include "Utils/Math.h"
 #include "Utils/Random.h"
+#include "Utils/Array2D.h"
 
 #include <vector>
 
@@ -14,6 +15,15 @@ namespace Expanse
 		float max;
 	};
 
+	/*
+	* Batch version of PerlinNoise: values[pt] = PerlinNoise(FPoint{ pt } * freq, seed) for every point of values.
+	* Gradients of lattice points are computed once per call and taken from a table instead of trigonometry,
+	* so results differ from PerlinNoise by less than PerlinFillTolerance.
+	*/
+	void PerlinNoiseFill(Array2D<float>& values, float freq, uint32_t seed);
+
+	constexpr float PerlinFillTolerance = 0.005f;
+
 	struct PerlinNoiseGenerator
 	{
 	public:
@@ -26,8 +36,11 @@ namespace Expanse
 
 		float Get(FPoint pos) const;
 
+		// Same as calling Get for every point of values, with tolerance of PerlinNoiseFill per harmonic
+		void Fill(Array2D<float>& values) const;
+
 	private:
 		std::vector<NoiseHarmonics> harmonics;
 		std::vector<uint32_t> seeds;
 	};
-}
\ No newline at end of file
+}
@@ -2,6 +2,15 @@
 
 #include "ECS/Entity.h"
 #include "ECS/World.h"
+#include "ECS/CommandBuffer.h"
+#include "ECS/Snapshot.h"
+#include "ECS/ArchetypeWorld.h"
+
+#include <string>
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <thread>
 
 namespace Expanse::Tests
 {
@@ -21,6 +30,31 @@ namespace Expanse::Tests
 		}
 	}
 
+	TEST(ECS, EntityLayouts)
+	{
+		using SmallEntity = ecs::TEntity<uint16_t, 2>;
+		using WideEntity = ecs::TEntity<uint64_t, 24>;
+
+		EXPECT_EQ(16383u, SmallEntity::MaxIndex);
+		EXPECT_EQ(3u, SmallEntity::MaxVersion);
+		EXPECT_EQ((uint64_t{ 1 } << 40) - 1, WideEntity::MaxIndex);
+		EXPECT_EQ((uint64_t{ 1 } << 24) - 1, WideEntity::MaxVersion);
+
+		const WideEntity ent{ WideEntity::MaxIndex - 1, WideEntity::MaxVersion };
+		EXPECT_EQ(WideEntity::MaxIndex - 1, ent.Index());
+		EXPECT_EQ(WideEntity::MaxVersion, ent.Version());
+		EXPECT_TRUE(ent);
+
+		// version wraps to zero without touching index bits
+		auto ent2 = ent;
+		ent2.IncVersion();
+		EXPECT_EQ(WideEntity::MaxIndex - 1, ent2.Index());
+		EXPECT_EQ(0u, ent2.Version());
+
+		EXPECT_FALSE(SmallEntity{});
+		EXPECT_FALSE(WideEntity{});
+	}
+
 	TEST(ECS, EntityAddAndRemove)
 	{
 		ecs::Entity ent;
@@ -41,6 +75,39 @@ namespace Expanse::Tests
 		EXPECT_FALSE(world.HasEntity(ent));
 	}
 
+	TEST(ECS, EntitySlotsReuse)
+	{
+		ecs::World world;
+		const auto ent0 = world.CreateEntity();
+		const auto ent1 = world.CreateEntity();
+		const auto ent2 = world.CreateEntity();
+
+		world.DestroyEntity(ent0);
+		world.DestroyEntity(ent2);
+
+		EXPECT_FALSE(world.HasEntity(ent0));
+		EXPECT_TRUE(world.HasEntity(ent1));
+		EXPECT_FALSE(world.HasEntity(ent2));
+
+		// slots are reused in reverse order of destruction, with new version
+		const auto ent3 = world.CreateEntity();
+		const auto ent4 = world.CreateEntity();
+
+		EXPECT_EQ(ent2.Index(), ent3.Index());
+		EXPECT_EQ(ent0.Index(), ent4.Index());
+		EXPECT_NE(ent2, ent3);
+		EXPECT_NE(ent0, ent4);
+
+		EXPECT_TRUE(world.HasEntity(ent3));
+		EXPECT_TRUE(world.HasEntity(ent4));
+		EXPECT_FALSE(world.HasEntity(ent0));
+		EXPECT_FALSE(world.HasEntity(ent2));
+
+		// free list is empty again, so new slot is allocated
+		const auto ent5 = world.CreateEntity();
+		EXPECT_EQ(3u, ent5.Index());
+	}
+
 
 	struct CompA {
 		int x = 0;
@@ -49,6 +116,84 @@ namespace Expanse::Tests
 	struct CompB {
 		float v = 0.0f;
 	};
+}
+
+namespace Expanse
+{
+	template<>
+	inline constexpr bool ecs::SnapshotComponent<Tests::CompA> = true;
+
+	template<>
+	inline constexpr bool ecs::SnapshotComponent<Tests::CompB> = true;
+}
+
+namespace Expanse::Tests
+{
+
+	TEST(ECS, TypeIds)
+	{
+		// ids are computed at compile time from type names
+		static_assert(ecs::ComponentTypeId<CompA> != ecs::ComponentTypeId<CompB>);
+		static_assert(ecs::ComponentTypeId<CompA> == ecs::HashTypeName("Expanse::Tests::CompA"));
+		EXPECT_EQ("Expanse::Tests::CompB", ecs::TypeName<CompB>());
+
+		const auto index_a = ecs::ComponentTypeIndex<CompA>;
+		EXPECT_EQ(index_a, ecs::ComponentTypeIndexOf(ecs::ComponentTypeId<CompA>));
+		EXPECT_EQ(ecs::TypeRegistry<ecs::_ComponentsTypeFamily>::NullIndex, ecs::ComponentTypeIndexOf(ecs::HashTypeName("NotAComponent")));
+
+		// every registered id is found through the perfect hash table
+		struct Family {};
+		using Registry = ecs::TypeRegistry<Family>;
+		std::vector<std::string> names;
+		for (int i = 0; i < 100; ++i) {
+			names.push_back("Type" + std::to_string(i));
+		}
+		for (size_t i = 0; i < names.size(); ++i) {
+			EXPECT_EQ(i, Registry::Register(ecs::HashTypeName(names[i]), names[i]));
+		}
+		for (size_t i = 0; i < names.size(); ++i)
+		{
+			EXPECT_EQ(i, Registry::IndexOf(ecs::HashTypeName(names[i])));
+			EXPECT_EQ(i, Registry::Register(ecs::HashTypeName(names[i]), names[i]));
+		}
+		EXPECT_EQ(names.size(), Registry::Count());
+	}
+
+	TEST(ECS, BatchCreateAndDestroy)
+	{
+		ecs::World world;
+		const auto ents = world.CreateEntities(100, CompA{ 7 }, CompB{ 1.5f });
+		EXPECT_EQ(100u, ents.size());
+		EXPECT_EQ(100u, world.GetEntitiesWith<CompA>().size());
+		EXPECT_EQ(7, world.GetComponent<const CompA>(ents[50])->x);
+		EXPECT_EQ(1.5f, world.GetComponent<const CompB>(ents[99])->v);
+
+		const auto plain = world.CreateEntities(10);
+		world.AddComponent<CompA>(plain[0], 1);
+
+		// destroy every other entity, along with one, that has only some of the components
+		std::vector<ecs::Entity> to_destroy;
+		for (size_t i = 0; i < ents.size(); i += 2) {
+			to_destroy.push_back(ents[i]);
+		}
+		to_destroy.push_back(plain[0]);
+		world.DestroyEntities(to_destroy);
+
+		for (size_t i = 0; i < ents.size(); ++i) {
+			EXPECT_EQ(i % 2 == 1, world.HasEntity(ents[i]));
+		}
+		EXPECT_FALSE(world.HasEntity(plain[0]));
+		EXPECT_EQ(50u, world.GetEntitiesWith<CompA>().size());
+		EXPECT_EQ(50u, world.GetEntitiesWith<CompB>().size());
+
+		int sum = 0;
+		world.ForEach<const CompA, const CompB>([&sum](ecs::Entity, const CompA& a, const CompB&) { sum += a.x; });
+		EXPECT_EQ(50 * 7, sum);
+
+		// freed slots are reused
+		const auto reused = world.CreateEntities(51);
+		EXPECT_TRUE(std::ranges::all_of(reused, [&world](ecs::Entity ent) { return world.HasEntity(ent) && ent.Index() < 110; }));
+	}
 
 	TEST(ECS, ComponentAddAndRemove)
 	{
@@ -69,6 +214,33 @@ namespace Expanse::Tests
 		EXPECT_EQ(nullptr, c);
 	}
 
+	TEST(ECS, ComponentRemoveKeepsOthers)
+	{
+		ecs::World world;
+		const auto ent0 = world.CreateEntity();
+		const auto ent1 = world.CreateEntity();
+		const auto ent2 = world.CreateEntity();
+
+		world.AddComponent<CompA>(ent0, 0);
+		world.AddComponent<CompA>(ent1, 1);
+		world.AddComponent<CompA>(ent2, 2);
+
+		EXPECT_TRUE(world.RemoveComponent<CompA>(ent0));
+		EXPECT_FALSE(world.RemoveComponent<CompA>(ent0));
+		EXPECT_FALSE(world.RemoveComponent<CompB>(ent1));
+
+		EXPECT_FALSE(world.HasComponent<CompA>(ent0));
+		EXPECT_EQ(1, world.GetComponent<CompA>(ent1)->x);
+		EXPECT_EQ(2, world.GetComponent<CompA>(ent2)->x);
+
+		// components of destroyed entity must not be visible through reused slot
+		world.DestroyEntity(ent2);
+		const auto ent3 = world.CreateEntity();
+		EXPECT_EQ(ent2.Index(), ent3.Index());
+		EXPECT_FALSE(world.HasComponent<CompA>(ent3));
+		EXPECT_EQ(1, world.GetComponent<CompA>(ent1)->x);
+	}
+
 	TEST(ECS, MultiComponentGet)
 	{
 		ecs::World world;
@@ -120,4 +292,1037 @@ namespace Expanse::Tests
 		EXPECT_EQ(0, a2->x);
 		EXPECT_EQ(0.0f, b2->v);
 	}
-}
\ No newline at end of file
+
+	TEST(ECS, ForEachOrderIndependent)
+	{
+		ecs::World world;
+		for (int i = 0; i < 10; ++i)
+		{
+			auto ent = world.CreateEntity();
+			world.AddComponent<CompA>(ent, i);
+			if (i % 3 == 0) {
+				world.AddComponent<CompB>(ent, static_cast<float>(i));
+			}
+		}
+
+		// smaller store drives iteration in both cases, result must be the same
+		int sum_ab = 0;
+		world.ForEach<CompA, CompB>([&sum_ab](ecs::Entity, const CompA& a, const CompB& b) {
+			EXPECT_EQ(static_cast<float>(a.x), b.v);
+			sum_ab += a.x;
+		});
+
+		int sum_ba = 0;
+		world.ForEach<CompB, CompA>([&sum_ba](ecs::Entity, const CompB& b, const CompA& a) {
+			EXPECT_EQ(static_cast<float>(a.x), b.v);
+			sum_ba += a.x;
+		});
+
+		EXPECT_EQ(0 + 3 + 6 + 9, sum_ab);
+		EXPECT_EQ(sum_ab, sum_ba);
+	}
+
+	struct CompC {};
+}
+
+namespace Expanse
+{
+	template<>
+	inline constexpr bool ecs::SnapshotComponent<Tests::CompC> = true;
+}
+
+namespace Expanse::Tests
+{
+
+	TEST(ECS, ForEachWithout)
+	{
+		ecs::World world;
+		auto ent0 = world.CreateEntity();
+		auto ent1 = world.CreateEntity();
+		auto ent2 = world.CreateEntity();
+
+		world.AddComponent<CompA>(ent0, 1);
+		world.AddComponent<CompA>(ent1, 2);
+		world.AddComponent<CompA>(ent2, 4);
+		world.AddComponent<CompB>(ent1);
+		world.AddComponent<CompC>(ent2);
+
+		int sum = 0;
+		world.ForEach<CompA, ecs::Without<CompB>>([&sum](ecs::Entity, const CompA& a) { sum += a.x; });
+		EXPECT_EQ(5, sum);
+
+		sum = 0;
+		world.ForEach<CompA, ecs::Without<CompB, CompC>>([&sum](ecs::Entity, const CompA& a) { sum += a.x; });
+		EXPECT_EQ(1, sum);
+
+		auto view = world.View<CompA, ecs::Without<CompC>>();
+		EXPECT_TRUE(view.Contains(ent0));
+		EXPECT_TRUE(view.Contains(ent1));
+		EXPECT_FALSE(view.Contains(ent2));
+
+		// store of excluded component doesn't exist yet
+		struct CompD {};
+		sum = 0;
+		world.ForEach<CompA, ecs::Without<CompD>>([&sum](ecs::Entity, const CompA& a) { sum += a.x; });
+		EXPECT_EQ(7, sum);
+	}
+
+	TEST(ECS, ForEachConstAccess)
+	{
+		ecs::World world;
+		auto ent = world.CreateEntity();
+		world.AddComponent<CompA>(ent, 3);
+		world.AddComponent<CompB>(ent, 0.0f);
+
+		world.ForEach<CompB, const CompA>([](ecs::Entity, CompB& b, const CompA& a) {
+			static_assert(std::is_same_v<decltype(a), const CompA&>);
+			b.v = static_cast<float>(a.x);
+		});
+		EXPECT_EQ(3.0f, world.GetComponent<CompB>(ent)->v);
+	}
+
+	TEST(ECS, ParallelForEach)
+	{
+		ecs::World world;
+		const int count = 10000;
+		for (int i = 0; i < count; ++i)
+		{
+			auto ent = world.CreateEntity();
+			world.AddComponent<CompA>(ent, i);
+			if (i % 4 != 0) {
+				world.AddComponent<CompB>(ent);
+			}
+		}
+
+		world.ParallelForEach<CompB, const CompA>([](ecs::Entity, CompB& b, const CompA& a) {
+			b.v = static_cast<float>(a.x * 2);
+		}, 100);
+
+		std::atomic<int> visited = 0;
+		world.ParallelForEach<const CompA, const CompB>([&visited](ecs::Entity, const CompA& a, const CompB& b) {
+			EXPECT_EQ(static_cast<float>(a.x * 2), b.v);
+			++visited;
+		}, 64);
+		EXPECT_EQ(count - count / 4, visited);
+
+		// grain larger than the store runs everything on the calling thread
+		visited = 0;
+		world.ParallelForEach<const CompA>([&visited](ecs::Entity, const CompA&) { ++visited; }, count * 2);
+		EXPECT_EQ(count, visited);
+	}
+
+	TEST(ECS, GroupOwning)
+	{
+		ecs::World world;
+		std::vector<ecs::Entity> ents;
+		for (int i = 0; i < 6; ++i)
+		{
+			ents.push_back(world.CreateEntity());
+			world.AddComponent<CompA>(ents.back(), i);
+		}
+		world.AddComponent<CompB>(ents[1], 1.0f);
+		world.AddComponent<CompB>(ents[4], 4.0f);
+
+		// existing entities are picked up on creation
+		auto group = world.Group<CompA, CompB>();
+		EXPECT_TRUE(group.IsOwning());
+		EXPECT_EQ(2u, group.Size());
+		// const access shares the same group
+		EXPECT_EQ(2u, (world.Group<const CompA, CompB>().Size()));
+
+		// components of entities outside the group don't change it
+		const auto generation = group.Generation();
+		world.AddComponent<CompC>(ents[2]);
+		world.RemoveComponent<CompA>(ents[2]);
+		EXPECT_EQ(generation, group.Generation());
+
+		world.AddComponent<CompB>(ents[5], 5.0f);
+		world.RemoveComponent<CompA>(ents[1]);
+		world.DestroyEntity(ents[4]);
+		world.AddComponent<CompB>(ents[0], 0.0f);
+
+		EXPECT_NE(generation, group.Generation());
+		EXPECT_EQ(2u, group.Size());
+		EXPECT_TRUE(group.Contains(ents[0]));
+		EXPECT_TRUE(group.Contains(ents[5]));
+		EXPECT_FALSE(group.Contains(ents[1]));
+		EXPECT_FALSE(group.Contains(ents[2]));
+
+		// members occupy the prefix of both stores in the same order
+		const auto& as = world.GetComponentArray<CompA>();
+		const auto& bs = world.GetComponentArray<CompB>();
+		for (size_t i = 0; i < group.Size(); ++i) {
+			EXPECT_EQ(static_cast<float>(as[i].x), bs[i].v);
+		}
+
+		int sum = 0;
+		group.ForEach([&sum](ecs::Entity, CompA& a, const CompB& b) {
+			EXPECT_EQ(static_cast<float>(a.x), b.v);
+			sum += a.x;
+		});
+		EXPECT_EQ(5, sum);
+
+		// pointers returned by AddComponent stay valid after the group moved the component
+		auto* b = world.AddComponent<CompB>(ents[3], 3.0f);
+		EXPECT_EQ(world.GetComponent<CompB>(ents[3]), b);
+		EXPECT_EQ(3u, group.Size());
+	}
+
+	TEST(ECS, GroupNonOwning)
+	{
+		ecs::World world;
+		auto owning = world.Group<CompA, CompB>();
+		auto shared = world.Group<CompA, CompC>();
+		EXPECT_TRUE(owning.IsOwning());
+		EXPECT_FALSE(shared.IsOwning());
+
+		std::vector<ecs::Entity> ents;
+		for (int i = 0; i < 5; ++i)
+		{
+			ents.push_back(world.CreateEntity());
+			world.AddComponent<CompA>(ents.back(), i);
+			if (i % 2 == 0) world.AddComponent<CompB>(ents.back(), static_cast<float>(i));
+			if (i >= 2) world.AddComponent<CompC>(ents.back());
+		}
+		world.RemoveComponent<CompC>(ents[3]);
+
+		int sum_owning = 0;
+		owning.ForEach([&sum_owning](ecs::Entity, const CompA& a, const CompB&) { sum_owning += a.x; });
+		EXPECT_EQ(0 + 2 + 4, sum_owning);
+
+		int sum_shared = 0;
+		shared.ForEach([&sum_shared](ecs::Entity, const CompA& a, const CompC&) { sum_shared += a.x; });
+		EXPECT_EQ(2 + 4, sum_shared);
+		EXPECT_EQ(2u, shared.Size());
+	}
+
+	TEST(ECS, SortInPlace)
+	{
+		ecs::World world;
+		std::vector<ecs::Entity> ents;
+		for (int i = 0; i < 50; ++i)
+		{
+			ents.push_back(world.CreateEntity());
+			world.AddComponent<CompA>(ents.back(), (i * 37) % 50);
+			if (i % 3 == 0) world.AddComponent<CompB>(ents.back(), static_cast<float>((i * 37) % 50));
+		}
+
+		auto less_a = [](const CompA& a1, const CompA& a2) { return a1.x < a2.x; };
+		auto less_b = [](const CompB& b1, const CompB& b2) { return b1.v < b2.v; };
+
+		// plain store, entities follow their components
+		world.Sort<CompA>(less_a);
+		EXPECT_TRUE(std::ranges::is_sorted(world.GetComponentArray<CompA>(), less_a));
+		for (int i = 0; i < 50; ++i) {
+			EXPECT_EQ((i * 37) % 50, world.GetComponent<const CompA>(ents[i])->x);
+		}
+
+		// owning group sorts its prefix in all owned stores, sorting the store leaves it alone
+		auto group = world.Group<CompA, CompB>();
+		ASSERT_TRUE(group.IsOwning());
+		group.Sort<CompB>(less_b);
+		world.Sort<CompA>([](const CompA& a1, const CompA& a2) { return a1.x > a2.x; });
+
+		const auto& as = world.GetComponentArray<CompA>();
+		const auto& bs = world.GetComponentArray<CompB>();
+		for (size_t i = 0; i < group.Size(); ++i) {
+			EXPECT_EQ(static_cast<float>(as[i].x), bs[i].v);
+		}
+		EXPECT_TRUE(std::is_sorted(bs.begin(), bs.begin() + group.Size(), less_b));
+		EXPECT_TRUE(std::is_sorted(as.begin() + group.Size(), as.end(), [](const CompA& a1, const CompA& a2) { return a1.x > a2.x; }));
+
+		// incremental sort picks up new members, sorting doesn't count as change
+		const auto tick = world.AdvanceTick();
+		world.AddComponent<CompB>(ents[1], 37.0f);
+		group.Sort<CompA>(less_a, ecs::SortMode::Incremental);
+
+		std::vector<int> visited;
+		world.Group<const CompA, const CompB>().ForEach([&visited](ecs::Entity, const CompA& a, const CompB&) { visited.push_back(a.x); });
+		EXPECT_EQ(group.Size(), visited.size());
+		EXPECT_TRUE(std::ranges::is_sorted(visited));
+
+		int changed = 0;
+		world.ForEach<const CompA, ecs::Changed<CompA>>([&changed](ecs::Entity, const CompA&) { ++changed; }, tick);
+		EXPECT_EQ(0, changed);
+
+		// non-owning group sorts its own set of entities only
+		for (int i = 0; i < 50; i += 2) {
+			world.AddComponent<CompC>(ents[i]);
+		}
+		auto shared = world.Group<CompA, CompC>();
+		ASSERT_FALSE(shared.IsOwning());
+		shared.Sort<CompA>(less_a);
+
+		visited.clear();
+		shared.ForEach([&visited](ecs::Entity, const CompA& a, const CompC&) { visited.push_back(a.x); });
+		EXPECT_EQ(25u, visited.size());
+		EXPECT_TRUE(std::ranges::is_sorted(visited));
+	}
+
+	TEST(ECS, AddedAndChangedFilters)
+	{
+		ecs::World world;
+		std::vector<ecs::Entity> ents;
+		for (int i = 0; i < 4; ++i)
+		{
+			ents.push_back(world.CreateEntity());
+			world.AddComponent<CompA>(ents.back(), i);
+		}
+
+		auto count_added = [&world](ecs::ChangeTick since) {
+			int count = 0;
+			world.ForEach<const CompA, ecs::Added<CompA>>([&count](ecs::Entity, const CompA&) { ++count; }, since);
+			return count;
+		};
+		auto count_changed = [&world](ecs::ChangeTick since) {
+			int count = 0;
+			world.ForEach<const CompA, ecs::Changed<CompA>>([&count](ecs::Entity, const CompA&) { ++count; }, since);
+			return count;
+		};
+
+		const auto tick1 = world.AdvanceTick();
+		EXPECT_EQ(4, count_added(0));
+		EXPECT_EQ(0, count_added(tick1));
+		EXPECT_EQ(0, count_changed(tick1));
+
+		// const access doesn't mark components
+		world.ForEach<const CompA>([](ecs::Entity, const CompA&) {});
+		EXPECT_FALSE((world.View<const CompA, ecs::Changed<CompA>>(tick1).Contains(ents[0])));
+		world.GetComponent<const CompA>(ents[0]);
+		EXPECT_EQ(0, count_changed(tick1));
+
+		world.GetComponent<CompA>(ents[1]);
+		world.AddComponent<CompA>(world.CreateEntity(), 10);
+		EXPECT_EQ(1, count_added(tick1));
+		EXPECT_EQ(2, count_changed(tick1));
+
+		// filtered component doesn't have to be passed to the callback
+		const auto tick2 = world.AdvanceTick();
+		world.AddComponent<CompB>(ents[2], 2.0f);
+		int sum = 0;
+		world.ForEach<const CompA, ecs::Added<CompB>>([&sum](ecs::Entity, const CompA& a) { sum += a.x; }, tick2);
+		EXPECT_EQ(2, sum);
+
+		// write access through views and groups marks visited components only
+		const auto tick3 = world.AdvanceTick();
+		world.ForEach<CompB>([](ecs::Entity, CompB& b) { b.v += 1.0f; });
+		world.Group<CompA, const CompB>().ForEach([](ecs::Entity, CompA&, const CompB&) {});
+		EXPECT_EQ(1, count_changed(tick3));
+		EXPECT_TRUE((world.View<const CompA, ecs::Changed<CompB>>(tick3).Contains(ents[2])));
+	}
+
+	TEST(ECS, ChangedFilterSkipsUntouchedStores)
+	{
+		ecs::World world;
+		for (int i = 0; i < 100; ++i) {
+			world.AddComponent<CompA>(world.CreateEntity(), i);
+		}
+		const auto since = world.AdvanceTick();
+
+		// store-wide tick tells there's nothing to visit
+		EXPECT_FALSE((world.View<const CompA, ecs::Changed<CompA>>(since).IsValid()));
+		EXPECT_EQ(0u, (world.View<const CompA, ecs::Changed<CompA>>(since).SizeHint()));
+
+		// filter on missing store never passes
+		EXPECT_FALSE((world.View<const CompA, ecs::Added<CompC>>().IsValid()));
+
+		world.ForEach<CompA>([](ecs::Entity, CompA& a) { ++a.x; });
+		EXPECT_TRUE((world.View<const CompA, ecs::Changed<CompA>>(since).IsValid()));
+	}
+
+	TEST(ECS, PagedComponentsKeepPointers)
+	{
+		using Pages = ecs::PagedVector<CompA>;
+
+		ecs::World world;
+		std::vector<ecs::Entity> ents;
+		std::vector<const CompA*> ptrs;
+		const int count = static_cast<int>(Pages::PageSize * 3 + 5);
+		for (int i = 0; i < count; ++i)
+		{
+			ents.push_back(world.CreateEntity());
+			ptrs.push_back(world.AddComponent<CompA>(ents.back(), i));
+		}
+
+		// growth never moves existing components
+		for (int i = 0; i < count; ++i) {
+			EXPECT_EQ(ptrs[i], world.GetComponent<const CompA>(ents[i]));
+		}
+
+		// component array is a random access range
+		const auto& as = world.GetComponentArray<CompA>();
+		EXPECT_EQ(static_cast<size_t>(count), as.size());
+		EXPECT_EQ(count - 1, as[count - 1].x);
+		EXPECT_EQ(count - 1, std::ranges::max_element(as, {}, &CompA::x)->x);
+
+		// owning group walks components across page boundaries of differently sized types
+		for (int i = 0; i < count; i += 2) {
+			world.AddComponent<CompB>(ents[i], static_cast<float>(i));
+		}
+		auto group = world.Group<const CompA, const CompB>();
+		int visited = 0;
+		group.ForEach([&visited](ecs::Entity, const CompA& a, const CompB& b) {
+			EXPECT_EQ(static_cast<float>(a.x), b.v);
+			++visited;
+		});
+		EXPECT_EQ((count + 1) / 2, visited);
+
+		// emptied pages go back to the allocator
+		Pages::Allocator::ReleaseUnused();
+		world.SetShrinkPolicy<CompA>(ecs::ComponentStoreBase::ShrinkPolicy::ReleaseEmptyPages);
+		for (int i = 0; i < count; ++i) {
+			world.DestroyEntity(ents[i]);
+		}
+		EXPECT_EQ(3u, Pages::Allocator::FreePagesCount());
+
+		world.Reserve<CompA>(Pages::PageSize * 2);
+		EXPECT_EQ(2u, Pages::Allocator::FreePagesCount());
+
+		// cached pages are reported and returned to the system on shrink
+		const auto cached_bytes = [&world] {
+			const auto stats = world.GetStats();
+			return std::ranges::find(stats.stores, std::string_view{ "Expanse::Tests::CompA" }, &ecs::StoreStats::name)->bytes_cached;
+		};
+		EXPECT_EQ(2 * Pages::PageSize * sizeof(CompA), cached_bytes());
+
+		world.ShrinkToFit();
+		EXPECT_EQ(0u, Pages::Allocator::FreePagesCount());
+		EXPECT_EQ(0u, cached_bytes());
+	}
+
+	struct TagD {};
+
+	TEST(ECS, TagComponents)
+	{
+		ecs::World world;
+		std::vector<ecs::Entity> ents;
+		for (int i = 0; i < 200; ++i)
+		{
+			ents.push_back(world.CreateEntity());
+			world.AddComponent<CompA>(ents.back(), i);
+			if (i % 2 == 0) world.AddComponent<TagD>(ents.back());
+		}
+		world.RemoveComponent<TagD>(ents[0]);
+
+		EXPECT_FALSE(world.HasComponent<TagD>(ents[0]));
+		EXPECT_TRUE(world.HasComponent<TagD>(ents[2]));
+		EXPECT_FALSE(world.HasComponent<TagD>(ents[3]));
+		EXPECT_EQ(nullptr, world.GetComponent<const TagD>(ents[1]));
+		EXPECT_NE(nullptr, world.GetComponent<const TagD>(ents[198]));
+		EXPECT_EQ(99u, world.GetEntitiesWith<TagD>().size());
+
+		int tagged = 0;
+		world.ForEach<const CompA, const TagD>([&tagged](ecs::Entity, const CompA& a, const TagD&) {
+			EXPECT_EQ(0, a.x % 2);
+			++tagged;
+		});
+		EXPECT_EQ(99, tagged);
+
+		int untagged = 0;
+		world.ForEach<const CompA, ecs::Without<TagD>>([&untagged](ecs::Entity, const CompA&) { ++untagged; });
+		EXPECT_EQ(101, untagged);
+
+		// tags can be members of owning groups
+		auto group = world.Group<const CompA, const TagD>();
+		EXPECT_TRUE(group.IsOwning());
+		int group_sum = 0;
+		group.ForEach([&group_sum](ecs::Entity, const CompA& a, const TagD&) { group_sum += a.x; });
+		EXPECT_EQ(99 * 100, group_sum);
+
+		// destroyed entity loses its tag, even if its index is reused
+		world.DestroyEntity(ents[2]);
+		const auto reused = world.CreateEntity();
+		EXPECT_EQ(ents[2].Index(), reused.Index());
+		EXPECT_FALSE(world.HasComponent<TagD>(reused));
+		EXPECT_EQ(98u, group.Size());
+
+		// stale handle doesn't see the tag of the entity, which took its slot
+		ecs::ComponentStore<TagD> store;
+		store.Create(reused, 1);
+		const ecs::ComponentStoreBase& base = store;
+		EXPECT_TRUE(base.Contains(reused));
+		EXPECT_FALSE(base.Contains(ents[2]));
+		EXPECT_FALSE(store.Contains(ents[2]));
+	}
+
+	TEST(ECS, CommandBufferPlayback)
+	{
+		ecs::World world;
+		std::vector<ecs::Entity> ents;
+		for (int i = 0; i < 4; ++i)
+		{
+			ents.push_back(world.CreateEntity());
+			world.AddComponent<CompA>(ents.back(), i);
+		}
+
+		ecs::CommandBuffer commands;
+		EXPECT_TRUE(commands.Empty());
+
+		// structural changes are recorded during iteration and applied after it
+		world.ForEach<const CompA>([&commands](ecs::Entity ent, const CompA& a) {
+			if (a.x % 2 == 0) {
+				commands.RemoveComponent<CompA>(ent);
+			} else {
+				commands.AddComponent<CompB>(ent, static_cast<float>(a.x));
+			}
+		});
+		const auto pending = commands.CreateEntity();
+		commands.AddComponent<CompA>(pending, 10);
+		commands.AddComponent<CompB>(pending, 10.0f);
+		commands.DestroyEntity(ents[3]);
+		commands.DestroyEntity(ents[3]);
+		EXPECT_FALSE(commands.Empty());
+		EXPECT_EQ(4u, world.GetEntitiesWith<CompA>().size());
+
+		// components of the same type are added in one batch
+		std::vector<size_t> added_batches;
+		world.OnAdd<CompB>([&added_batches](const ecs::ObservedBatch<CompB>& batch) { added_batches.push_back(batch.Size()); });
+
+		commands.Playback(world);
+		EXPECT_TRUE(commands.Empty());
+		EXPECT_EQ(std::vector<size_t>{ 3 }, added_batches);
+
+		EXPECT_FALSE(world.HasComponent<CompA>(ents[0]));
+		EXPECT_EQ(1.0f, world.GetComponent<const CompB>(ents[1])->v);
+		EXPECT_FALSE(world.HasComponent<CompA>(ents[2]));
+		EXPECT_FALSE(world.HasEntity(ents[3]));
+
+		int sum = 0;
+		world.ForEach<const CompA, const CompB>([&sum](ecs::Entity, const CompA& a, const CompB&) { sum += a.x; });
+		EXPECT_EQ(1 + 10, sum);
+
+		// buffer is reusable after playback
+		commands.RemoveComponent<CompB>(ents[1]);
+		commands.Playback(world);
+		EXPECT_FALSE(world.HasComponent<CompB>(ents[1]));
+	}
+
+	TEST(ECS, CommandBufferLastCommandWins)
+	{
+		ecs::World world;
+		const auto ent0 = world.CreateEntity();
+		const auto ent1 = world.CreateEntity();
+		const auto ent2 = world.CreateEntity();
+		world.AddComponent<CompA>(ent0, 1);
+		world.AddComponent<CompA>(ent1, 1);
+
+		ecs::CommandBuffer commands;
+		// component is replaced
+		commands.RemoveComponent<CompA>(ent0);
+		commands.AddComponent<CompA>(ent0, 2);
+		// component is removed
+		commands.AddComponent<CompA>(ent1, 3);
+		commands.RemoveComponent<CompA>(ent1);
+		// only the last value is added
+		commands.AddComponent<CompA>(ent2, 4);
+		commands.RemoveComponent<CompA>(ent2);
+		commands.AddComponent<CompA>(ent2, 5);
+		commands.AddComponent<CompA>(ent2, 6);
+		commands.Playback(world);
+
+		EXPECT_EQ(2, world.GetComponent<const CompA>(ent0)->x);
+		EXPECT_FALSE(world.HasComponent<CompA>(ent1));
+		EXPECT_EQ(6, world.GetComponent<const CompA>(ent2)->x);
+		EXPECT_EQ(2u, world.GetEntitiesWith<CompA>().size());
+	}
+
+	TEST(ECS, CommandBufferConstructsLikeWorld)
+	{
+		ecs::World world;
+		const auto ent0 = world.CreateEntity();
+		const auto ent1 = world.CreateEntity();
+
+		// parentheses pick the count constructor, braces would pick the initializer list
+		world.AddComponent<std::vector<int>>(ent0, 3u, 7);
+
+		ecs::CommandBuffer commands;
+		commands.AddComponent<std::vector<int>>(ent1, 3u, 7);
+		commands.Playback(world);
+
+		EXPECT_EQ(*world.GetComponent<const std::vector<int>>(ent0), *world.GetComponent<const std::vector<int>>(ent1));
+	}
+
+	TEST(ECS, ThreadCommandBuffersOrderIndependent)
+	{
+		// one thread destroys entity, another one adds component to it
+		for (const bool destroying_first : { true, false })
+		{
+			ecs::World world;
+			const auto ent0 = world.CreateEntity();
+			const auto ent1 = world.CreateEntity();
+
+			ecs::ThreadCommandBuffers commands;
+			const std::function<void()> destroy = [&] {
+				commands.Local().DestroyEntity(ent0);
+				commands.Local().DestroyEntity(ent1);
+			};
+			const std::function<void()> add = [&] {
+				commands.Local().AddComponent<CompA>(ent0, 1);
+				commands.Local().AddComponent<CompA>(ent1, 1);
+				commands.Local().DestroyEntity(ent1);
+			};
+
+			// buffers are ordered by threads' first access
+			std::thread{ destroying_first ? destroy : add }.join();
+			std::thread{ destroying_first ? add : destroy }.join();
+			commands.Playback(world);
+
+			EXPECT_FALSE(world.HasEntity(ent0));
+			EXPECT_FALSE(world.HasEntity(ent1));
+			EXPECT_EQ(0u, world.GetEntitiesWith<CompA>().size());
+		}
+	}
+
+	TEST(ECS, ThreadCommandBuffers)
+	{
+		ecs::World world;
+		const int count = 10000;
+		for (int i = 0; i < count; ++i) {
+			world.AddComponent<CompA>(world.CreateEntity(), i);
+		}
+
+		ecs::ThreadCommandBuffers commands;
+		world.ParallelForEach<const CompA>([&commands](ecs::Entity ent, const CompA& a) {
+			if (a.x % 3 == 0) {
+				commands.Local().DestroyEntity(ent);
+			} else {
+				commands.Local().AddComponent<CompB>(ent, static_cast<float>(a.x));
+			}
+		}, 100);
+		commands.Playback(world);
+
+		EXPECT_EQ(static_cast<size_t>(count - (count + 2) / 3), world.GetEntitiesWith<CompA>().size());
+		EXPECT_EQ(world.GetEntitiesWith<CompA>().size(), world.GetEntitiesWith<CompB>().size());
+	}
+
+	TEST(ECS, EventsDoubleBuffered)
+	{
+		ecs::World world;
+		auto& events = world.GetEvents<CompA>();
+		EXPECT_EQ(&events, &(world.GetEvents<CompA>()));
+
+		ecs::Events<CompA>::Reader early_reader;
+		ecs::Events<CompA>::Reader late_reader;
+		auto read_sum = [&events](ecs::Events<CompA>::Reader& reader) {
+			int sum = 0;
+			events.Read(reader, [&sum](const CompA& event) { sum += event.x; });
+			return sum;
+		};
+
+		// early reader runs before the sender, late one after it
+		EXPECT_EQ(0, read_sum(early_reader));
+		events.Send({ 1 });
+		events.Emplace(2);
+		EXPECT_TRUE(events.HasUnread(late_reader));
+		EXPECT_EQ(3, read_sum(late_reader));
+		EXPECT_FALSE(events.HasUnread(late_reader));
+
+		world.UpdateEvents();
+		EXPECT_EQ(3, read_sum(early_reader));
+		events.Send({ 4 });
+		EXPECT_EQ(4, read_sum(late_reader));
+
+		// events are kept for two frames only
+		world.UpdateEvents();
+		world.UpdateEvents();
+		events.Send({ 8 });
+		EXPECT_EQ(8, read_sum(early_reader));
+		EXPECT_EQ(8, read_sum(late_reader));
+		EXPECT_EQ(0, read_sum(late_reader));
+	}
+
+	TEST(ECS, Observers)
+	{
+		ecs::World world;
+		world.Group<CompA, CompB>();
+
+		std::vector<size_t> add_batches;
+		std::vector<size_t> remove_batches;
+		int added_sum = 0;
+		int removed_sum = 0;
+		const auto add_id = world.OnAdd<CompA>([&](const ecs::ObservedBatch<CompA>& batch) {
+			add_batches.push_back(batch.Size());
+			batch.ForEach([&](auto, const CompA& comp) { added_sum += comp.x; });
+		});
+		world.OnRemove<CompA>([&](const ecs::ObservedBatch<CompA>& batch) {
+			remove_batches.push_back(batch.Size());
+			batch.ForEach([&](auto entity, const CompA& comp) {
+				EXPECT_TRUE(world.HasComponent<CompA>(entity));
+				removed_sum += comp.x;
+			});
+		});
+
+		// batch operations deliver one batch
+		auto ents = world.CreateEntities(100, CompA{ 2 }, CompB{});
+		EXPECT_EQ(std::vector<size_t>{ 100 }, add_batches);
+		EXPECT_EQ(200, added_sum);
+
+		world.AddComponent<CompA>(world.CreateEntity(), 5);
+		EXPECT_EQ((std::vector<size_t>{ 100, 1 }), add_batches);
+		EXPECT_EQ(205, added_sum);
+
+		std::vector<ecs::Entity> removed(ents.begin(), ents.begin() + 10);
+		removed.push_back(ents[0]);
+		world.RemoveComponents<CompA>(removed);
+		EXPECT_EQ(std::vector<size_t>{ 10 }, remove_batches);
+		EXPECT_EQ(20, removed_sum);
+
+		world.DestroyEntities(std::span{ ents }.subspan(50));
+		world.DestroyEntity(ents[20]);
+		EXPECT_EQ((std::vector<size_t>{ 10, 50, 1 }), remove_batches);
+		EXPECT_EQ(122, removed_sum);
+		EXPECT_EQ(39u, (world.Group<CompA, CompB>().Size()));
+
+		// removed observer is not called, other ones are
+		world.RemoveObserver<CompA>(add_id);
+		world.AddComponent<CompA>(ents[0], 1);
+		EXPECT_EQ(2u, add_batches.size());
+		world.RemoveComponent<CompA>(ents[0]);
+		EXPECT_EQ(123, removed_sum);
+	}
+
+	// Component with heap data, saved through its serializer
+	struct CompName
+	{
+		std::string name;
+	};
+
+	// Not serializable, skipped by snapshots
+	struct CompHandle
+	{
+		std::unique_ptr<int> ptr;
+	};
+
+	// Trivially copyable, but meaningless after restore, so it doesn't opt in
+	struct CompGpuId
+	{
+		uint32_t id = 0;
+	};
+}
+
+namespace Expanse
+{
+	template<>
+	inline constexpr bool ecs::SnapshotComponent<Tests::CompName> = true;
+
+	template<>
+	struct Serializer<Tests::CompName>
+	{
+		static void Write(BinaryWriter& out, const Tests::CompName& comp)
+		{
+			out.Write(comp.name.size());
+			out.WriteBytes(comp.name.data(), comp.name.size());
+		}
+
+		static void Read(BinaryReader& in, Tests::CompName& comp)
+		{
+			comp.name.resize(in.Read<size_t>());
+			in.ReadBytes(comp.name.data(), comp.name.size());
+		}
+	};
+}
+
+namespace Expanse::Tests
+{
+	TEST(ECS, Stats)
+	{
+		ecs::World world;
+		std::vector<ecs::Entity> ents;
+		for (int i = 0; i < 1000; ++i)
+		{
+			ents.push_back(world.CreateEntity());
+			world.AddComponent<CompA>(ents.back(), i);
+			if (i % 2 == 0) world.AddComponent<CompC>(ents.back());
+		}
+		for (int i = 0; i < 100; ++i) {
+			world.DestroyEntity(ents[i]);
+		}
+		world.BeginFrame();
+
+		// churn is reported for the last complete frame
+		world.AddComponent<CompB>(ents[500], 1.0f);
+		world.RemoveComponent<CompA>(ents[501]);
+
+		auto stats = world.GetStats();
+		EXPECT_EQ(1000u, stats.entities.slots);
+		EXPECT_EQ(900u, stats.entities.live);
+		EXPECT_EQ(100u, stats.entities.free);
+		EXPECT_EQ(0u, stats.entities.version_overflows);
+
+		const auto find_store = [&stats](std::string_view name) {
+			return std::ranges::find(stats.stores, name, &ecs::StoreStats::name);
+		};
+		const auto store_a = find_store("Expanse::Tests::CompA");
+		ASSERT_NE(stats.stores.end(), store_a);
+		EXPECT_EQ(899u, store_a->size);
+		EXPECT_GE(store_a->capacity, 1000u);
+		EXPECT_GE(store_a->bytes_used, 899 * sizeof(CompA));
+		EXPECT_EQ(1000u, store_a->frame_adds);
+		EXPECT_EQ(100u, store_a->frame_removes);
+
+		world.BeginFrame();
+		stats = world.GetStats();
+		EXPECT_EQ(0u, find_store("Expanse::Tests::CompA")->frame_adds);
+		EXPECT_EQ(1u, find_store("Expanse::Tests::CompA")->frame_removes);
+		EXPECT_EQ(1u, find_store("Expanse::Tests::CompB")->frame_adds);
+		EXPECT_EQ(450u, find_store("Expanse::Tests::CompC")->size);
+
+		// wasted memory grows, when components are removed and pages are kept
+		const auto wasted = find_store("Expanse::Tests::CompA")->bytes_wasted;
+		for (int i = 100; i < 1000; ++i) {
+			world.RemoveComponent<CompA>(ents[i]);
+		}
+		stats = world.GetStats();
+		EXPECT_GT(find_store("Expanse::Tests::CompA")->bytes_wasted, wasted);
+		EXPECT_EQ(0u, find_store("Expanse::Tests::CompA")->bytes_used);
+
+		const auto text = ecs::FormatStats(stats);
+		EXPECT_NE(std::string::npos, text.find("900 live"));
+		EXPECT_NE(std::string::npos, text.find("Expanse::Tests::CompB"));
+
+		// stale handles match again once slot version wraps around
+		auto entity = world.CreateEntity();
+		for (size_t i = 0; i <= ecs::Entity::MaxVersion; ++i)
+		{
+			world.DestroyEntity(entity);
+			entity = world.CreateEntity();
+		}
+		EXPECT_EQ(1u, world.GetStats().entities.version_overflows);
+	}
+
+	TEST(ECS, SnapshotRoundTrip)
+	{
+		ecs::World world;
+		std::vector<ecs::Entity> ents;
+		for (int i = 0; i < 3000; ++i)
+		{
+			ents.push_back(world.CreateEntity());
+			world.AddComponent<CompA>(ents.back(), i);
+			if (i % 2 == 0) world.AddComponent<CompB>(ents.back(), i * 0.5f);
+			if (i % 3 == 0) world.AddComponent<CompC>(ents.back());
+			if (i % 5 == 0) world.AddComponent<CompName>(ents.back(), "entity " + std::to_string(i));
+			if (i % 7 == 0) world.AddComponent<CompHandle>(ents.back(), std::make_unique<int>(i));
+			world.AddComponent<CompGpuId>(ents.back(), static_cast<uint32_t>(i));
+		}
+		for (int i = 0; i < 3000; i += 11) {
+			world.DestroyEntity(ents[i]);
+		}
+
+		const auto path = (std::filesystem::temp_directory_path() / "expanse_snapshot_test.bin").string();
+		ASSERT_TRUE(ecs::SaveSnapshot(world, path));
+
+		// groups created before loading pick up restored entities
+		ecs::World restored;
+		auto group = restored.Group<CompA, CompB>();
+		ASSERT_TRUE(ecs::LoadSnapshot(restored, path));
+		std::filesystem::remove(path);
+
+		size_t in_group = 0;
+		for (int i = 0; i < 3000; ++i)
+		{
+			const auto entity = ents[i];
+			ASSERT_EQ(world.HasEntity(entity), restored.HasEntity(entity));
+			if (!world.HasEntity(entity)) continue;
+
+			EXPECT_EQ(i, restored.GetComponent<const CompA>(entity)->x);
+			EXPECT_EQ(world.HasComponent<CompB>(entity), restored.HasComponent<CompB>(entity));
+			EXPECT_EQ(world.HasComponent<CompC>(entity), restored.HasComponent<CompC>(entity));
+			EXPECT_FALSE(restored.HasComponent<CompHandle>(entity));
+			EXPECT_FALSE(restored.HasComponent<CompGpuId>(entity));
+
+			if (const auto* b = world.GetComponent<const CompB>(entity))
+			{
+				EXPECT_EQ(b->v, restored.GetComponent<const CompB>(entity)->v);
+				EXPECT_TRUE(group.Contains(entity));
+				++in_group;
+			}
+			if (const auto* name = world.GetComponent<const CompName>(entity)) {
+				EXPECT_EQ(name->name, restored.GetComponent<const CompName>(entity)->name);
+			}
+		}
+		EXPECT_EQ(in_group, group.Size());
+
+		// free list is restored too, so both worlds reuse the same slots
+		for (int i = 0; i < 10; ++i) {
+			EXPECT_EQ(world.CreateEntity(), restored.CreateEntity());
+		}
+
+		// restored components count as added
+		int added = 0;
+		restored.ForEach<const CompA, ecs::Added<CompA>>([&added](ecs::Entity, const CompA&) { ++added; }, 0);
+		EXPECT_EQ(3000 - 273, added);
+	}
+
+	TEST(ECS, SnapshotRejectsCorruptedData)
+	{
+		ecs::World world;
+		for (int i = 0; i < 100; ++i) {
+			world.AddComponent<CompName>(world.CreateEntity(), std::string(i, 'x'));
+		}
+
+		BinaryWriter out;
+		world.WriteSnapshot(out);
+		const auto data = out.Data();
+
+		// truncated data is detected
+		for (size_t size : { size_t{ 0 }, size_t{ 10 }, data.size() / 2, data.size() - 1 })
+		{
+			ecs::World restored;
+			BinaryReader in{ data.first(size) };
+			EXPECT_FALSE(restored.ReadSnapshot(in));
+		}
+
+		ecs::World restored;
+		BinaryReader in{ data };
+		EXPECT_TRUE(restored.ReadSnapshot(in));
+	}
+
+	TEST(ECS, SnapshotRejectsInvalidEntityTable)
+	{
+		ecs::World world;
+		std::vector<ecs::Entity> ents;
+		for (int i = 0; i < 10; ++i)
+		{
+			ents.push_back(world.CreateEntity());
+			world.AddComponent<CompA>(ents.back(), i);
+		}
+		world.DestroyEntity(ents[3]);
+		world.DestroyEntity(ents[7]);
+
+		BinaryWriter out;
+		world.WriteSnapshot(out);
+		const auto data = out.Data();
+
+		// magic, version, entity size, slots count
+		const size_t head_offset = 3 * sizeof(uint32_t) + sizeof(uint64_t);
+		const size_t table_offset = head_offset + sizeof(ecs::Entity::BaseType);
+
+		const auto read_patched = [&data](size_t offset, ecs::Entity::BaseType value) {
+			std::vector<std::byte> patched{ data.begin(), data.end() };
+			std::memcpy(patched.data() + offset, &value, sizeof(value));
+
+			ecs::World restored;
+			BinaryReader in{ patched };
+			return restored.ReadSnapshot(in);
+		};
+		const auto slot_offset = [table_offset](size_t index) { return table_offset + index * sizeof(ecs::EntityStore); };
+
+		// free list head out of range, or pointing to a live slot
+		EXPECT_FALSE(read_patched(head_offset, 100));
+		EXPECT_FALSE(read_patched(head_offset, 0));
+		// free list, which loops or skips a free slot: 7 -> 3 -> end
+		EXPECT_FALSE(read_patched(slot_offset(3), ecs::Entity{ 7, 1 }.Value()));
+		EXPECT_FALSE(read_patched(slot_offset(7), ecs::Entity{ ecs::Entity::MaxIndex, 1 }.Value()));
+		EXPECT_FALSE(read_patched(slot_offset(7), ecs::Entity{ 100, 1 }.Value()));
+		// component of an entity, whose version doesn't match the table
+		EXPECT_FALSE(read_patched(slot_offset(5), ecs::Entity{ 5, 1 }.Value()));
+
+		EXPECT_TRUE(read_patched(head_offset, ents[7].Index()));
+	}
+
+	TEST(ECS, ArchetypeAddAndRemove)
+	{
+		ecs::ArchetypeWorld world;
+		const auto ent0 = world.CreateEntity();
+		const auto ent1 = world.CreateEntity();
+
+		world.AddComponent<CompA>(ent0, 1);
+		world.AddComponent<CompA>(ent1, 2);
+		world.AddComponent<CompB>(ent1, 2.0f);
+		world.AddComponent<std::string>(ent1, "ent1");
+
+		EXPECT_EQ(1, world.GetComponent<CompA>(ent0)->x);
+		EXPECT_EQ(nullptr, world.GetComponent<CompB>(ent0));
+		EXPECT_EQ(2, world.GetComponent<CompA>(ent1)->x);
+		EXPECT_EQ(2.0f, world.GetComponent<CompB>(ent1)->v);
+		EXPECT_EQ("ent1", *world.GetComponent<std::string>(ent1));
+
+		// remaining components are moved to the new archetype intact
+		EXPECT_TRUE(world.RemoveComponent<CompB>(ent1));
+		EXPECT_FALSE(world.RemoveComponent<CompB>(ent1));
+		EXPECT_FALSE(world.HasComponent<CompB>(ent1));
+		EXPECT_EQ(2, world.GetComponent<CompA>(ent1)->x);
+		EXPECT_EQ("ent1", *world.GetComponent<std::string>(ent1));
+
+		world.DestroyEntity(ent0);
+		EXPECT_FALSE(world.HasEntity(ent0));
+		EXPECT_EQ(2, world.GetComponent<CompA>(ent1)->x);
+
+		const auto ent2 = world.CreateEntity();
+		EXPECT_EQ(ent0.Index(), ent2.Index());
+		EXPECT_FALSE(world.HasComponent<CompA>(ent2));
+	}
+
+	TEST(ECS, ArchetypeManyChunks)
+	{
+		ecs::ArchetypeWorld world;
+
+		// enough entities to fill several chunks
+		const int count = 10000;
+		std::vector<ecs::Entity> entities;
+		for (int i = 0; i < count; ++i)
+		{
+			entities.push_back(world.CreateEntity());
+			world.AddComponent<CompA>(entities.back(), i);
+			world.AddComponent<std::string>(entities.back(), std::to_string(i));
+		}
+
+		// erasing from the middle moves last rows into holes
+		for (int i = 0; i < count; i += 2) {
+			world.DestroyEntity(entities[i]);
+		}
+
+		for (int i = 1; i < count; i += 2)
+		{
+			ASSERT_EQ(i, world.GetComponent<CompA>(entities[i])->x);
+			ASSERT_EQ(std::to_string(i), *world.GetComponent<std::string>(entities[i]));
+		}
+
+		int matched = 0;
+		world.ForEach<CompA, std::string>([&matched](ecs::Entity, const CompA& a, const std::string& s) {
+			EXPECT_EQ(std::to_string(a.x), s);
+			++matched;
+		});
+		EXPECT_EQ(count / 2, matched);
+	}
+
+	TEST(ECS, ArchetypeForEachWithout)
+	{
+		ecs::ArchetypeWorld world;
+		auto ent0 = world.CreateEntity();
+		auto ent1 = world.CreateEntity();
+		auto ent2 = world.CreateEntity();
+
+		world.AddComponent<CompA>(ent0, 1);
+		world.AddComponent<CompA>(ent1, 2);
+		world.AddComponent<CompA>(ent2, 4);
+		world.AddComponent<CompB>(ent1);
+		world.AddComponent<CompC>(ent2);
+
+		int sum = 0;
+		world.ForEach<CompA>([&sum](ecs::Entity, const CompA& a) { sum += a.x; });
+		EXPECT_EQ(7, sum);
+
+		sum = 0;
+		world.ForEach<CompA, ecs::Without<CompB>>([&sum](ecs::Entity, const CompA& a) { sum += a.x; });
+		EXPECT_EQ(5, sum);
+
+		sum = 0;
+		world.ForEach<CompA, ecs::Without<CompB, CompC>>([&sum](ecs::Entity, const CompA& a) { sum += a.x; });
+		EXPECT_EQ(1, sum);
+	}
+
+	TEST(ECS, ArchetypeTooLargeComponent)
+	{
+		struct Huge { char data[ecs::Archetype::ChunkSize]; };
+
+		ecs::ArchetypeWorld world;
+		auto ent = world.CreateEntity();
+		world.AddComponent<CompA>(ent, 3);
+
+		EXPECT_EQ(nullptr, world.AddComponent<Huge>(ent));
+		EXPECT_FALSE(world.HasComponent<Huge>(ent));
+		ASSERT_NE(nullptr, world.GetComponent<CompA>(ent));
+		EXPECT_EQ(3, world.GetComponent<CompA>(ent)->x);
+	}
+}
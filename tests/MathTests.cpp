@@ -3,6 +3,8 @@
 #include "Utils/Math.h"
 #include "Utils/Random.h"
 #include "Utils/Bounds.h"
+#include "Utils/PerlinNoiseGenerator.h"
+#include "Utils/RectPoints.h"
 
 #include "TestUtils.h"
 
@@ -53,6 +55,14 @@ namespace Expanse::Tests
 		EXPECT_FRECT_EQ(expected, result);
 	}
 
+	TEST(FRectScale, ScaledFromCenter)
+	{
+		const auto rect = FRect{ -1.0f, 0.0f, 2.0f, 4.0f };
+
+		EXPECT_FRECT_EQ((FRect{ -2.0f, -2.0f, 4.0f, 8.0f }), ScaledFromCenter(rect, 2.0f));
+		EXPECT_FRECT_EQ((FRect{ -0.5f, -2.0f, 1.0f, 8.0f }), ScaledFromCenter(rect, FPoint{ 0.5f, 2.0f }));
+	}
+
 
 
 
@@ -80,6 +90,29 @@ namespace Expanse::Tests
 		}
 	}
 
+	TEST(RandomTests, PerlinNoiseFillMatchesScalar)
+	{
+		// negative coordinates and rects, which don't start at lattice points
+		const Rect rect{ -45, -13, 70, 41 };
+
+		for (const float freq : { 0.05f, 0.07f, 0.27f, 1.3f })
+		{
+			Array2D<float> values{ rect };
+			PerlinNoiseFill(values, freq, 12345u);
+
+			for (const Point pt : utils::rect_points(rect)) {
+				ASSERT_NEAR(PerlinNoise(FPoint{ pt } * freq, 12345u), values[pt], PerlinFillTolerance) << pt.x << ", " << pt.y;
+			}
+		}
+
+		const PerlinNoiseGenerator gen{ 7u, { { 0.05f, -6.0f, 6.0f }, { 0.27f, -3.0f, 3.0f } } };
+		Array2D<float> heights{ rect };
+		gen.Fill(heights);
+		for (const Point pt : utils::rect_points(rect)) {
+			ASSERT_NEAR(gen.Get(FPoint{ pt }), heights[pt], (12.0f + 6.0f) * PerlinFillTolerance);
+		}
+	}
+
 
 
 	TEST(BoundsTests, EmptyRectIfNoInput)
@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+
+#include "Game/ISystem.h"
+#include "Game/World.h"
+
+#include <mutex>
+#include <thread>
+
+namespace Expanse::Tests
+{
+	namespace
+	{
+		struct CompA {};
+		struct CompB {};
+		struct CompC {};
+
+		// Records order of updates into shared log
+		class LogSystem : public Game::ISystem
+		{
+		public:
+			LogSystem(Game::World& w, std::vector<int>& log, std::mutex& mutex, int id, Game::SystemAccess acc)
+				: ISystem(w), log(log), mutex(mutex), id(id)
+			{
+				access = acc;
+			}
+
+			void Update() override
+			{
+				std::scoped_lock lock(mutex);
+				log.push_back(id);
+			}
+
+		private:
+			std::vector<int>& log;
+			std::mutex& mutex;
+			int id;
+		};
+
+		size_t PositionOf(const std::vector<int>& log, int id)
+		{
+			return std::ranges::find(log, id) - log.begin();
+		}
+	}
+
+	TEST(Systems, AccessConflicts)
+	{
+		Game::SystemAccess read_a, write_a, write_b, read_ab, structural, main1, main2, undeclared;
+		read_a.Read<CompA>();
+		write_a.Write<CompA>();
+		write_b.Write<CompB>();
+		read_ab.Read<CompA, CompB>();
+		structural.Structural().Read<CompC>();
+		main1.MainThread();
+		main2.MainThread().Read<CompA>();
+
+		EXPECT_FALSE(read_a.ConflictsWith(read_ab));
+		EXPECT_FALSE(write_a.ConflictsWith(write_b));
+		EXPECT_TRUE(write_a.ConflictsWith(read_ab));
+		EXPECT_TRUE(read_ab.ConflictsWith(write_b));
+		EXPECT_TRUE(structural.ConflictsWith(read_a));
+		EXPECT_TRUE(main1.ConflictsWith(main2));
+		EXPECT_FALSE(main1.ConflictsWith(read_a));
+		EXPECT_TRUE(undeclared.ConflictsWith(read_a));
+		EXPECT_TRUE(undeclared.IsMainThread());
+	}
+
+	TEST(Systems, ConflictingSystemsKeepOrder)
+	{
+		Game::World world;
+		Game::SystemCollection systems{ world };
+
+		std::vector<int> log;
+		std::mutex mutex;
+
+		Game::SystemAccess write_a, read_a, write_b, main_thread;
+		write_a.Write<CompA>();
+		read_a.Read<CompA>();
+		write_b.Write<CompB>();
+		main_thread.MainThread().Read<CompB>();
+
+		systems.AddSystem<LogSystem>(log, mutex, 0, write_a);
+		systems.AddSystem<LogSystem>(log, mutex, 1, write_b);
+		systems.AddSystem<LogSystem>(log, mutex, 2, read_a);
+		systems.AddSystem<LogSystem>(log, mutex, 3, main_thread);
+		systems.AddSystem<LogSystem>(log, mutex, 4, read_a);
+
+		for (int frame = 0; frame < 20; ++frame)
+		{
+			log.clear();
+			systems.Update();
+
+			ASSERT_EQ(5u, log.size());
+			EXPECT_LT(PositionOf(log, 0), PositionOf(log, 2));
+			EXPECT_LT(PositionOf(log, 0), PositionOf(log, 4));
+			EXPECT_LT(PositionOf(log, 1), PositionOf(log, 3));
+		}
+
+		const auto& timings = systems.GetTimings();
+		ASSERT_EQ(5u, timings.size());
+		EXPECT_NE(std::string::npos, timings[0].name.find("LogSystem"));
+		EXPECT_TRUE(timings[3].main_thread);
+		EXPECT_FALSE(timings[0].main_thread);
+		EXPECT_TRUE(std::ranges::any_of(timings, &Game::SystemTiming::on_critical_path));
+		EXPECT_LE(systems.GetCriticalPathTime(), systems.GetUpdateTime());
+	}
+
+	TEST(Systems, MainThreadSystemsRunOnCaller)
+	{
+		Game::World world;
+		Game::SystemCollection systems{ world };
+
+		std::vector<std::thread::id> threads;
+		class ThreadSystem : public Game::ISystem
+		{
+		public:
+			ThreadSystem(Game::World& w, std::vector<std::thread::id>& ids) : ISystem(w), ids(ids)
+			{
+				access.MainThread();
+			}
+			void Update() override { ids.push_back(std::this_thread::get_id()); }
+		private:
+			std::vector<std::thread::id>& ids;
+		};
+
+		systems.AddSystem<ThreadSystem>(threads);
+		systems.AddSystem<ThreadSystem>(threads);
+		systems.Update();
+
+		ASSERT_EQ(2u, threads.size());
+		EXPECT_EQ(std::this_thread::get_id(), threads[0]);
+		EXPECT_EQ(std::this_thread::get_id(), threads[1]);
+	}
+}
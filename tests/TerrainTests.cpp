@@ -0,0 +1,268 @@
+#include "gtest/gtest.h"
+
+#include "Game/Terrain/ChunkMap.h"
+#include "Game/Terrain/Systems/DiskTerrain.h"
+#include "Game/Terrain/Systems/GenerateTerrain.h"
+#include "Game/Terrain/TerrainHelpers.h"
+#include "Utils/RectPoints.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+
+namespace Expanse::Tests
+{
+	using namespace Game::Terrain;
+
+	TEST(ChunkMap, InsertFindErase)
+	{
+		ChunkMap map{ { 4, 4 } };
+		const ecs::Entity a{ 1 }, b{ 2 };
+
+		EXPECT_FALSE(map.Find({ 0, 0 }));
+
+		map.Insert({ -1, -3 }, a);
+		EXPECT_EQ(a, map.Find({ -1, -3 }));
+		// same cell modulo map size
+		EXPECT_FALSE(map.Find({ 3, 1 }));
+
+		// erasing other entity is ignored
+		const auto generation = map.Generation();
+		map.Erase({ -1, -3 }, b);
+		EXPECT_EQ(a, map.Find({ -1, -3 }));
+		EXPECT_EQ(generation, map.Generation());
+
+		map.Erase({ -1, -3 }, a);
+		EXPECT_FALSE(map.Find({ -1, -3 }));
+		EXPECT_GT(map.Generation(), generation);
+	}
+
+	TEST(ChunkMap, ScrollingDoesNotGrow)
+	{
+		ChunkMap map{ { 8, 8 } };
+		ecs::Entity::BaseType next = 1;
+
+		// 8x8 window of chunks moves along x, chunks leaving it are erased
+		for (int x = 0; x < 8; ++x)
+			for (int y = 0; y < 8; ++y)
+				map.Insert({ x, y }, ecs::Entity{ next++ });
+
+		for (int step = 1; step < 100; ++step)
+		{
+			for (int y = 0; y < 8; ++y)
+			{
+				const Point old_pos{ step - 1, y };
+				map.Erase(old_pos, map.Find(old_pos));
+				map.Insert({ step + 7, y }, ecs::Entity{ next++ });
+			}
+		}
+
+		EXPECT_EQ((Point{ 8, 8 }), map.Size());
+		EXPECT_TRUE(map.Find({ 99, 0 }));
+		EXPECT_FALSE(map.Find({ 98, 0 }));
+	}
+
+	TEST(ChunkMap, GrowsOnCollision)
+	{
+		ChunkMap map{ { 4, 4 } };
+		for (int x = 0; x < 10; ++x) {
+			map.Insert({ x, 1 }, ecs::Entity{ static_cast<ecs::Entity::BaseType>(x + 1) });
+		}
+
+		EXPECT_EQ((Point{ 16, 4 }), map.Size());
+		for (int x = 0; x < 10; ++x) {
+			EXPECT_EQ(ecs::Entity{ static_cast<ecs::Entity::BaseType>(x + 1) }, map.Find({ x, 1 }));
+		}
+	}
+
+	TEST(PackedTerrainCells, RoundTrip)
+	{
+		TerrainCellsArray cells{ TerrainChunk::Area };
+		for (Point pos : utils::rect_points(cells.types.GetRect())) {
+			cells.types[pos] = static_cast<TerrainType>((pos.x / 5 + pos.y / 7) % 3);
+		}
+		for (Point pos : utils::rect_points(cells.heights.GetRect())) {
+			cells.heights[pos] = static_cast<HeightType>(pos.x / 4 - pos.y / 3 - 5);
+		}
+
+		const PackedTerrainCells packed{ cells };
+		const auto unpacked = packed.Unpack();
+		EXPECT_EQ(cells.types, unpacked.types);
+		EXPECT_EQ(cells.heights, unpacked.heights);
+
+		// 2 bits per type and 2 bits per height difference
+		EXPECT_LT(packed.MemorySize(), (cells.types.Size() + cells.heights.Size()) / 3);
+	}
+
+	TEST(PackedTerrainCells, SingleTypeAndNoisyHeights)
+	{
+		TerrainCellsArray cells{ TerrainChunk::Area };
+		std::ranges::fill(cells.types, TerrainType{ 7 });
+		int i = 0;
+		for (auto& height : cells.heights) {
+			height = static_cast<HeightType>((i++ * 37) % 251 - 125);
+		}
+
+		const PackedTerrainCells packed{ cells };
+		const auto unpacked = packed.Unpack();
+		EXPECT_EQ(cells.types, unpacked.types);
+		EXPECT_EQ(cells.heights, unpacked.heights);
+	}
+
+	TEST(PackedTerrainCells, ChunkPackUnpack)
+	{
+		TerrainChunk chunk{ { 3, -4 } };
+		chunk.cells.types[{ 31, 31 }] = 2;
+		chunk.cells.heights[{ 0, 32 }] = -3;
+
+		chunk.Pack();
+		ASSERT_TRUE(chunk.IsPacked());
+		EXPECT_TRUE(chunk.cells.types.Empty());
+
+		TerrainCellsArray scratch;
+		EXPECT_EQ(2, (chunk.GetCells(scratch).types[{ 31, 31 }]));
+		EXPECT_TRUE(chunk.IsPacked());
+
+		chunk.Unpack();
+		EXPECT_FALSE(chunk.IsPacked());
+		EXPECT_EQ(2, (chunk.cells.types[{ 31, 31 }]));
+		EXPECT_EQ(-3, (chunk.cells.heights[{ 0, 32 }]));
+	}
+
+	namespace
+	{
+		// Region indices are read in the background
+		bool WaitIndexLoaded(const TerrainLoader_Disk& loader)
+		{
+			for (int i = 0; i < 1000 && !loader.IsIndexLoaded(); ++i) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			}
+			return loader.IsIndexLoaded();
+		}
+
+		void SaveChunks(Game::World& world, const std::string& dir, const std::vector<Point>& positions)
+		{
+			TerrainLoader_Disk loader{ world, dir, 42u };
+
+			std::vector<ecs::Entity> chunks;
+			for (const auto pos : positions)
+			{
+				chunks.push_back(world.entities.CreateEntity());
+				auto* chunk = world.entities.AddComponent<TerrainChunk>(chunks.back(), pos);
+				chunk->cells.types[{ 1, 2 }] = static_cast<TerrainType>(pos.x + 3);
+				chunk->cells.heights[{ 32, 32 }] = static_cast<HeightType>(pos.y);
+			}
+
+			// destroying loader waits for background writes
+			world.entities.DestroyEntities(chunks);
+		}
+	}
+
+	TEST(DiskTerrain, SavesUnloadedChunks)
+	{
+		const auto dir = (std::filesystem::temp_directory_path() / "expanse_terrain_cache_test").string();
+		std::filesystem::remove_all(dir);
+
+		const std::vector<Point> positions = { { 0, 0 }, { -1, -17 }, { 15, 16 } };
+
+		Game::World world;
+		SaveChunks(world, dir, positions);
+
+		TerrainLoader_Disk loader{ world, dir, 42u };
+		ASSERT_TRUE(WaitIndexLoaded(loader));
+		for (const auto pos : positions)
+		{
+			ASSERT_TRUE(loader.HasChunk(pos));
+			const auto cells = loader.LoadChunk(pos).get();
+			EXPECT_EQ(TerrainChunk::Area, cells.types.GetRect());
+			EXPECT_EQ(static_cast<TerrainType>(pos.x + 3), (cells.types[{ 1, 2 }]));
+			EXPECT_EQ(static_cast<HeightType>(pos.y), (cells.heights[{ 32, 32 }]));
+		}
+		EXPECT_FALSE(loader.HasChunk({ 1, 0 }));
+
+		// cache of another world is ignored
+		TerrainLoader_Disk other_loader{ world, dir, 43u };
+		ASSERT_TRUE(WaitIndexLoaded(other_loader));
+		EXPECT_FALSE(other_loader.HasChunk(positions[0]));
+
+		std::filesystem::remove_all(dir);
+	}
+
+	TEST(DiskTerrain, KeepsSeedWithCache)
+	{
+		const auto dir = (std::filesystem::temp_directory_path() / "expanse_terrain_seed_test").string();
+		std::filesystem::remove_all(dir);
+
+		EXPECT_EQ(42u, TerrainLoader_Disk::LoadOrCreateSeed(dir, 42u));
+		EXPECT_EQ(42u, TerrainLoader_Disk::LoadOrCreateSeed(dir, 43u));
+
+		std::filesystem::remove_all(dir);
+		EXPECT_EQ(43u, TerrainLoader_Disk::LoadOrCreateSeed(dir, 43u));
+
+		std::filesystem::remove_all(dir);
+	}
+
+	TEST(DiskTerrain, GeneratesDamagedChunks)
+	{
+		const auto dir = (std::filesystem::temp_directory_path() / "expanse_terrain_damaged_test").string();
+		std::filesystem::remove_all(dir);
+
+		const Point pos{ 3, 4 };
+		Game::World world;
+		SaveChunks(world, dir, { pos });
+
+		// chunk data is cut off, index still points to it
+		const auto path = dir + "/r.0.0.bin";
+		std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+		TerrainLoader_Disk loader{ world, dir, 42u };
+		ASSERT_TRUE(WaitIndexLoaded(loader));
+		ASSERT_TRUE(loader.HasChunk(pos));
+
+		const auto cells = loader.LoadChunk(pos).get();
+		const auto generated = TerrainLoader_Procedural{ 42u }.GenerateChunk(pos);
+		EXPECT_TRUE(std::ranges::equal(generated.types, cells.types));
+		EXPECT_TRUE(std::ranges::equal(generated.heights, cells.heights));
+		EXPECT_FALSE(loader.HasChunk(pos));
+
+		std::filesystem::remove_all(dir);
+	}
+
+	TEST(LoadChunks, PacksChunksOutsideMeshArea)
+	{
+		const auto dir = (std::filesystem::temp_directory_path() / "expanse_terrain_load_test").string();
+		std::filesystem::remove_all(dir);
+
+		const Point window_size{ 640, 480 };
+		{
+			Game::World world;
+			LoadChunks load{ world, 42u, dir, window_size };
+
+			// zoomed out, so that the view covers several chunks
+			world.camera_scale = 4.0f;
+
+			const auto map_area = GetMapAreaToLoad(world, window_size);
+			const auto mesh_area = GetMeshAreaToLoad(world, window_size);
+			ASSERT_NE(map_area, mesh_area);
+
+			for (int i = 0; i < 1000; ++i)
+			{
+				load.Update();
+				if (GetNotLoadedChunksInArea(world, map_area).empty() && world.entities.GetEntitiesWith<AsyncLoadingChunk>().empty())
+					break;
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			}
+			ASSERT_TRUE(GetNotLoadedChunksInArea(world, map_area).empty());
+
+			int packed_count = 0;
+			world.entities.ForEach<const TerrainChunk>([&](auto, const TerrainChunk& chunk)
+			{
+				EXPECT_EQ(!Contains(mesh_area, chunk.position), chunk.IsPacked());
+				packed_count += chunk.IsPacked() ? 1 : 0;
+			});
+			EXPECT_GT(packed_count, 0);
+		}
+
+		std::filesystem::remove_all(dir);
+	}
+}